@@ -0,0 +1,435 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+#include "lib_mem/AllocatorSafe.h"
+#include "lib_mem/BitmapAllocator.h"
+#include "lib_mem/Memory.h"
+#include "lib_mem/TlsfAllocator.h"
+#include <stdint.h>
+}
+
+// Each iteration allocates one block and, once kWindow blocks are live, frees
+// one of them chosen by the free order. The pools are pre-filled with single
+// element blocks, a random share of which is freed again so that the free
+// space is scattered like in a long running system.
+
+constexpr size_t kElementSize   = 8;
+constexpr size_t kWindow        = 16;
+constexpr size_t kNumSizes      = 4096;
+constexpr size_t kMaxElements   = 64;
+
+enum SizeDistribution
+{
+    SIZE_FIXED,
+    SIZE_UNIFORM,
+    SIZE_POWER_LAW
+};
+
+enum FreeOrder
+{
+    FREE_LIFO,
+    FREE_FIFO,
+    FREE_RANDOM
+};
+
+/*----------------------------------------------------------------------------*/
+static std::vector<size_t>
+Benchmark_makeSizes(int distribution)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> uniform(1, kMaxElements);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<size_t> sizes(kNumSizes);
+
+    for (auto& size : sizes)
+    {
+        size_t numElements = 1;
+
+        switch (distribution)
+        {
+        case SIZE_UNIFORM:
+            numElements = uniform(rng);
+            break;
+        case SIZE_POWER_LAW:
+            // Pareto with alpha 1.2, most blocks are small, a few are large
+            numElements = std::min(kMaxElements,
+                                   (size_t) (1.0 / std::pow(1.0 - unit(rng),
+                                                            1.0 / 1.2)));
+            break;
+        default:
+            numElements = 1;
+            break;
+        }
+        // requests are not always whole elements
+        size = numElements * kElementSize - (numElements > 1 ? 3 : 0);
+    }
+    return sizes;
+}
+
+// removes and returns the block to free next
+static void*
+Benchmark_pickVictim(std::vector<void*>& live, int order, std::mt19937& rng)
+{
+    size_t pos = 0;
+
+    switch (order)
+    {
+    case FREE_LIFO:
+        pos = live.size() - 1;
+        break;
+    case FREE_FIFO:
+        pos = 0;
+        break;
+    default:
+        pos = rng() % live.size();
+        break;
+    }
+    void* victim = live[pos];
+    if (FREE_FIFO == order)
+    {
+        live.erase(live.begin());
+    }
+    else
+    {
+        live[pos] = live.back();
+        live.pop_back();
+    }
+    return victim;
+}
+
+template <typename Alloc, typename Free>
+static void
+Benchmark_run(benchmark::State& state,
+              int distribution,
+              int order,
+              Alloc alloc,
+              Free free)
+{
+    std::vector<size_t> sizes = Benchmark_makeSizes(distribution);
+    std::vector<void*> live;
+    std::mt19937 rng(7);
+    size_t i = 0;
+    size_t failed = 0;
+
+    live.reserve(kWindow + 1);
+
+    for (auto _ : state)
+    {
+        void* ptr = alloc(sizes[i++ % kNumSizes]);
+        if (NULL == ptr)
+        {
+            failed++;
+        }
+        else
+        {
+            live.push_back(ptr);
+        }
+        if (live.size() > kWindow || (NULL == ptr && !live.empty()))
+        {
+            free(Benchmark_pickVictim(live, order, rng));
+        }
+    }
+    for (void* ptr : live)
+    {
+        free(ptr);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["failed"] = benchmark::Counter((double) failed,
+                                                  benchmark::Counter::kAvgIterations);
+}
+
+// allocates every element and frees a random share of them, leaving fill
+// percent of the pool allocated
+static void
+Benchmark_fill(BitmapAllocator* bmAllocator, size_t numElements, int fill)
+{
+    Allocator* allocator = BitmapAllocator_TO_ALLOCATOR(bmAllocator);
+    std::vector<void*> blocks(numElements);
+    std::mt19937 rng(1);
+
+    size_t count = Allocator_allocBatch(allocator,
+                                        kElementSize,
+                                        blocks.data(),
+                                        numElements);
+    blocks.resize(count);
+    std::shuffle(blocks.begin(), blocks.end(), rng);
+
+    size_t numFreed = numElements - numElements * fill / 100;
+    Allocator_freeBatch(allocator,
+                        blocks.data(),
+                        std::min(numFreed, blocks.size()));
+}
+
+/*----------------------------------------------------------------------------*/
+// args: pool size in elements, fill percent, size distribution, free order
+static void
+BM_BitmapAllocator(benchmark::State& state)
+{
+    size_t numElements = state.range(0);
+    BitmapAllocator bmAllocator;
+    Allocator* allocator = BitmapAllocator_TO_ALLOCATOR(&bmAllocator);
+
+    if (!BitmapAllocator_ctor(&bmAllocator, kElementSize, numElements))
+    {
+        state.SkipWithError("can not create the pool");
+        return;
+    }
+    Benchmark_fill(&bmAllocator, numElements, state.range(1));
+
+    Benchmark_run(state,
+                  state.range(2),
+                  state.range(3),
+                  [allocator](size_t size)
+    {
+        return BitmapAllocator_alloc(allocator, size);
+    },
+    [allocator](void* ptr)
+    {
+        BitmapAllocator_free(allocator, ptr);
+    });
+
+    BitmapAllocator_dtor(allocator);
+}
+
+static void
+Benchmark_bitmapArgs(benchmark::internal::Benchmark* bench)
+{
+    // 512 bytes to 128 MiB pools
+    for (int64_t numElements : { 64, 1 << 10, 1 << 14, 1 << 18, 1 << 24 })
+    {
+        for (int fill : { 0, 50, 90, 99 })
+        {
+            for (int distribution : { SIZE_FIXED, SIZE_UNIFORM, SIZE_POWER_LAW })
+            {
+                for (int order : { FREE_LIFO, FREE_FIFO, FREE_RANDOM })
+                {
+                    bench->Args({ numElements, fill, distribution, order });
+                }
+            }
+        }
+    }
+    bench->ArgNames({ "elements", "fill", "sizes", "order" });
+}
+
+BENCHMARK(BM_BitmapAllocator)->Apply(Benchmark_bitmapArgs);
+
+/*----------------------------------------------------------------------------*/
+// the pool is filled with blocks of one element, every other one is freed
+// again and only the last kTail blocks leave room for a larger one. The bitmap
+// scan crosses the whole pool, the TLSF lookup does not depend on its size.
+// args: pool size in blocks, 0 for BitmapAllocator or 1 for TlsfAllocator
+enum FragmentedPool
+{
+    POOL_BITMAP,
+    POOL_TLSF
+};
+
+template <typename Free>
+static void
+Benchmark_punchHoles(std::vector<void*>& blocks, Free free)
+{
+    constexpr size_t kTail = 16;
+
+    for (size_t i = 0; i < blocks.size(); i++)
+    {
+        if (i % 2 || i >= blocks.size() - kTail)
+        {
+            free(blocks[i]);
+        }
+    }
+}
+
+static void
+BM_FragmentedPool(benchmark::State& state)
+{
+    constexpr size_t kBlockSize = 16;
+    size_t numBlocks = state.range(0);
+    std::vector<void*> blocks(numBlocks);
+    std::vector<uint8_t> buffer;
+    BitmapAllocator bmAllocator;
+    TlsfAllocator tlsfAllocator;
+    Allocator* allocator = NULL;
+
+    if (POOL_BITMAP == state.range(1)
+        && BitmapAllocator_ctor(&bmAllocator, kBlockSize, numBlocks))
+    {
+        allocator = BitmapAllocator_TO_ALLOCATOR(&bmAllocator);
+    }
+    else if (POOL_TLSF == state.range(1))
+    {
+        // a header per block and the pool's own overhead
+        buffer.resize(numBlocks * (kBlockSize + TlsfAllocator_ALIGN_SIZE)
+                      + 4 * TlsfAllocator_ALIGN_SIZE);
+        if (TlsfAllocator_ctorStatic(&tlsfAllocator,
+                                     buffer.data(),
+                                     buffer.size()))
+        {
+            allocator = TlsfAllocator_TO_ALLOCATOR(&tlsfAllocator);
+        }
+    }
+    if (NULL == allocator
+        || Allocator_allocBatch(allocator, kBlockSize, blocks.data(),
+                                numBlocks) != numBlocks)
+    {
+        state.SkipWithError("can not create the pool");
+        return;
+    }
+    Benchmark_punchHoles(blocks, [allocator](void* ptr)
+    {
+        Allocator_free(allocator, ptr);
+    });
+
+    for (auto _ : state)
+    {
+        void* ptr = Allocator_alloc(allocator, 4 * kBlockSize);
+        benchmark::DoNotOptimize(ptr);
+        Allocator_free(allocator, ptr);
+    }
+    state.SetItemsProcessed(state.iterations());
+    Allocator_dtor(allocator);
+}
+
+BENCHMARK(BM_FragmentedPool)
+->ArgsProduct({ { 1 << 10, 1 << 18 }, { POOL_BITMAP, POOL_TLSF } })
+->ArgNames({ "blocks", "pool" });
+
+/*----------------------------------------------------------------------------*/
+// one empty pool shared by all the threads, so that the lock dominates. It is
+// created in main() before any run, as the threads only give their blocks back
+// after the end of the timed loop. args: size distribution, free order
+static BitmapAllocator  Benchmark_safePool;
+static AllocatorSafe    Benchmark_safe;
+static Mutex*           Benchmark_mutex;
+static bool             Benchmark_safeReady;
+
+static bool
+Benchmark_createSafePool(void)
+{
+    constexpr size_t kNumElements = 1 << 20;
+    bool retval = false;
+
+    Benchmark_mutex = Mutex_create();
+    if (NULL == Benchmark_mutex)
+    {
+        retval = false;
+    }
+    else if (!BitmapAllocator_ctor(&Benchmark_safePool,
+                                   kElementSize,
+                                   kNumElements))
+    {
+        Mutex_destroy(Benchmark_mutex);
+    }
+    else if (!AllocatorSafe_ctor(&Benchmark_safe,
+                                 BitmapAllocator_TO_ALLOCATOR(
+                                     &Benchmark_safePool),
+                                 Benchmark_mutex))
+    {
+        BitmapAllocator_dtor(BitmapAllocator_TO_ALLOCATOR(&Benchmark_safePool));
+        Mutex_destroy(Benchmark_mutex);
+    }
+    else
+    {
+        retval = true;
+    }
+    return retval;
+}
+
+static void
+Benchmark_destroySafePool(void)
+{
+    Allocator_dtor(AllocatorSafe_TO_ALLOCATOR(&Benchmark_safe));
+    BitmapAllocator_dtor(BitmapAllocator_TO_ALLOCATOR(&Benchmark_safePool));
+    Mutex_destroy(Benchmark_mutex);
+}
+
+static void
+BM_AllocatorSafe(benchmark::State& state)
+{
+    Allocator* allocator = AllocatorSafe_TO_ALLOCATOR(&Benchmark_safe);
+
+    // every thread has to skip, or the others wait for it at the start of the
+    // timed loop
+    if (!Benchmark_safeReady)
+    {
+        state.SkipWithError("can not create the pool");
+        return;
+    }
+
+    Benchmark_run(state,
+                  state.range(0),
+                  state.range(1),
+                  [allocator](size_t size)
+    {
+        return Allocator_alloc(allocator, size);
+    },
+    [allocator](void* ptr)
+    {
+        Allocator_free(allocator, ptr);
+    });
+}
+
+BENCHMARK(BM_AllocatorSafe)
+->ArgsProduct({ { SIZE_FIXED, SIZE_UNIFORM, SIZE_POWER_LAW },
+    { FREE_LIFO, FREE_FIFO, FREE_RANDOM } })
+->ArgNames({ "sizes", "order" })
+->ThreadRange(1, std::max(1u, std::thread::hardware_concurrency()))
+->UseRealTime();
+
+/*----------------------------------------------------------------------------*/
+// the stdlib baseline, args: size distribution, free order
+static void
+BM_Memory(benchmark::State& state)
+{
+    Benchmark_run(state,
+                  state.range(0),
+                  state.range(1),
+                  [](size_t size)
+    {
+        return Memory_alloc(size);
+    },
+    [](void* ptr)
+    {
+        Memory_free(ptr);
+    });
+}
+
+BENCHMARK(BM_Memory)
+->ArgsProduct({ { SIZE_FIXED, SIZE_UNIFORM, SIZE_POWER_LAW },
+    { FREE_LIFO, FREE_FIFO, FREE_RANDOM } })
+->ArgNames({ "sizes", "order" });
+
+/*----------------------------------------------------------------------------*/
+int
+main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    Benchmark_safeReady = Benchmark_createSafePool();
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    if (Benchmark_safeReady)
+    {
+        Benchmark_destroySafePool();
+    }
+    return 0;
+}
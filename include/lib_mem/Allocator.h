@@ -24,6 +24,7 @@
 #include "lib_debug/Debug.h"
 
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 
 
@@ -41,11 +42,38 @@ typedef void
 typedef void
 (*Allocator_DtorT)(Allocator* self);
 
+typedef size_t
+(*Allocator_AllocBatchT)(Allocator* self, size_t size, void** ptrs, size_t num);
+
+typedef void
+(*Allocator_FreeBatchT)(Allocator* self, void** ptrs, size_t num);
+
+typedef void*
+(*Allocator_ReallocT)(Allocator* self, void* ptr, size_t size);
+
+typedef size_t
+(*Allocator_UsableSizeT)(Allocator* self, void* ptr);
+
+typedef void*
+(*Allocator_AllocAlignedT)(Allocator* self, size_t size, size_t alignment);
+
 typedef struct
 {
-    Allocator_AllocT       alloc;
-    Allocator_FreeT        free;
-    Allocator_DtorT        dtor;
+    Allocator_AllocT        alloc;
+    Allocator_FreeT         free;
+    Allocator_DtorT         dtor;
+    // optional, NULL makes the Allocator_xxxBatch() calls fall back to a loop
+    Allocator_AllocBatchT   allocBatch;
+    Allocator_FreeBatchT    freeBatch;
+    // optional, NULL makes Allocator_realloc() allocate, copy and free, which
+    // needs usableSize
+    Allocator_ReallocT      realloc;
+    // optional, NULL makes Allocator_usableSize() return 0 and, without
+    // realloc, Allocator_realloc() fail
+    Allocator_UsableSizeT   usableSize;
+    // optional, NULL makes Allocator_allocAligned() accept only blocks that
+    // happen to be aligned
+    Allocator_AllocAlignedT allocAligned;
 }
 Allocator_Vtable;
 
@@ -79,6 +107,124 @@ Allocator_dtor(Allocator* self)
     return self->vtable->dtor(self);
 }
 
+/**
+ * @brief allocates 'num' blocks of 'size' bytes each
+ *
+ * @param self pointer to the allocator instance
+ * @param size size of each block
+ * @param ptrs output array receiving the addresses of the blocks
+ * @param num number of blocks requested
+ *
+ * @return the number of blocks allocated, stored in ptrs[0] onwards. If less
+ *  than 'num' then the allocator ran out of memory
+ */
+INLINE size_t
+Allocator_allocBatch(Allocator* self, size_t size, void** ptrs, size_t num)
+{
+    Debug_ASSERT_SELF(self);
+
+    size_t count = 0;
+
+    if (self->vtable->allocBatch != NULL)
+    {
+        count = self->vtable->allocBatch(self, size, ptrs, num);
+    }
+    else
+    {
+        for (; count < num; count++)
+        {
+            ptrs[count] = self->vtable->alloc(self, size);
+            if (NULL == ptrs[count])
+            {
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief frees 'num' blocks, NULL entries are ignored
+ *
+ * @param self pointer to the allocator instance
+ * @param ptrs array of the addresses of the blocks
+ * @param num number of entries in ptrs
+ */
+INLINE void
+Allocator_freeBatch(Allocator* self, void** ptrs, size_t num)
+{
+    Debug_ASSERT_SELF(self);
+
+    if (self->vtable->freeBatch != NULL)
+    {
+        self->vtable->freeBatch(self, ptrs, num);
+    }
+    else
+    {
+        for (size_t i = 0; i < num; i++)
+        {
+            self->vtable->free(self, ptrs[i]);
+        }
+    }
+}
+
+/**
+ * @brief returns the number of bytes that can be used in an allocated block,
+ *  which may be more than requested
+ *
+ * @param self pointer to the allocator instance
+ * @param ptr start of the block
+ *
+ * @return the usable size, 0 if ptr is not allocated or the allocator can not
+ *  tell
+ */
+INLINE size_t
+Allocator_usableSize(Allocator* self, void* ptr)
+{
+    Debug_ASSERT_SELF(self);
+
+    return (self->vtable->usableSize != NULL && ptr != NULL)
+           ? self->vtable->usableSize(self, ptr)
+           : 0;
+}
+
+/**
+ * @brief allocates a block whose address is a multiple of 'alignment'
+ *
+ * @param self pointer to the allocator instance
+ * @param size size of the block
+ * @param alignment required alignment, a power of two
+ *
+ * @return the address of the block or NULL if the allocator has no suitably
+ *  aligned space
+ */
+INLINE void*
+Allocator_allocAligned(Allocator* self, size_t size, size_t alignment)
+{
+    Debug_ASSERT_SELF(self);
+    Debug_ASSERT(alignment && !(alignment & (alignment - 1)));
+
+    void* retval = NULL;
+
+    if (self->vtable->allocAligned != NULL)
+    {
+        retval = self->vtable->allocAligned(self, size, alignment);
+    }
+    else
+    {
+        // without knowledge of the allocator internals we can not pick the
+        // place, and over allocating would break Allocator_free()
+        retval = self->vtable->alloc(self, size);
+
+        if (retval != NULL && ((uintptr_t) retval & (alignment - 1)))
+        {
+            self->vtable->free(self, retval);
+            retval = NULL;
+        }
+    }
+    return retval;
+}
+
 /* Exported static functions -------------------------------------------------*/
 
 INLINE void*
@@ -95,21 +241,53 @@ Allocator_calloc(Allocator* self, size_t nmemb, size_t size)
     return retval;
 }
 
+/**
+ * @brief resizes an allocated block, keeping its content up to the smaller of
+ *  the old and the new size
+ *
+ * @param self pointer to the allocator instance
+ * @param ptr start of the block, NULL makes it an Allocator_alloc()
+ * @param size new size, 0 frees the block
+ *
+ * @return the address of the resized block or NULL on failure, in which case
+ *  the original block is left untouched. Allocators with neither a realloc nor
+ *  a usableSize implementation always fail to move a block
+ */
 INLINE void*
 Allocator_realloc(Allocator* self, void* ptr, size_t size)
 {
     Debug_ASSERT_SELF(self);
 
-    void* dest = self->vtable->alloc(self, size);
+    void* dest = NULL;
 
-    if (dest != NULL && ptr != NULL && size != 0)
+    if (self->vtable->realloc != NULL)
+    {
+        dest = self->vtable->realloc(self, ptr, size);
+    }
+    else if (NULL == ptr)
     {
-        memcpy(dest, ptr, size);
+        dest = self->vtable->alloc(self, size);
     }
-    if (ptr != NULL)
+    else if (!size)
     {
         self->vtable->free(self, ptr);
     }
+    else
+    {
+        // without the old size there is no telling how much to copy, copying
+        // the new size would read past the end of the block
+        size_t oldSize = Allocator_usableSize(self, ptr);
+
+        if (!oldSize)
+        {
+            Debug_LOG_WARNING("%s: size of ptr @%p is unknown", __func__, ptr);
+        }
+        else if ((dest = self->vtable->alloc(self, size)) != NULL)
+        {
+            memcpy(dest, ptr, (oldSize < size) ? oldSize : size);
+            self->vtable->free(self, ptr);
+        }
+    }
     return dest;
 }
 
@@ -48,9 +48,29 @@ AllocatorSafe_ctor(AllocatorSafe*   self,
 void*
 AllocatorSafe_alloc(Allocator* allocator, size_t size);
 
+void*
+AllocatorSafe_allocAligned(Allocator* allocator,
+                           size_t size,
+                           size_t alignment);
+
 void
 AllocatorSafe_free(Allocator* allocator, void* ptr);
 
+size_t
+AllocatorSafe_allocBatch(Allocator* allocator,
+                         size_t size,
+                         void** ptrs,
+                         size_t num);
+
+void
+AllocatorSafe_freeBatch(Allocator* allocator, void** ptrs, size_t num);
+
+void*
+AllocatorSafe_realloc(Allocator* allocator, void* ptr, size_t size);
+
+size_t
+AllocatorSafe_usableSize(Allocator* allocator, void* ptr);
+
 void
 AllocatorSafe_dtor(Allocator* allocator);
 
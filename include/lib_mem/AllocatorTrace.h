@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+*/
+
+/**
+ * @addtogroup lib_mem
+ * @{
+ *
+ * @file AllocatorTrace.h
+ *
+ * @brief an allocator recording the requests it forwards to another one
+ *
+ * Every request is forwarded to the wrapped allocator and then recorded in a
+ * caller provided ring buffer. Writers claim a record with an atomic increment
+ * and never block, when the ring is full the oldest records are overwritten.
+ * The records can be read concurrently with AllocatorTrace_Ring_read(), a
+ * trace file is the plain array of the records read, which the replay program
+ * built under test/ feeds to another allocator.
+ */
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/Allocator.h"
+
+#include <stdint.h>
+
+/* Exported macro ------------------------------------------------------------*/
+
+#define AllocatorTrace_TO_ALLOCATOR(self)  (&(self)->parent)
+
+/* Exported types ------------------------------------------------------------*/
+
+typedef struct AllocatorTrace AllocatorTrace;
+
+typedef enum
+{
+    AllocatorTrace_Op_ALLOC = 1,
+    AllocatorTrace_Op_FREE,
+    // arg is the address of the block that was resized
+    AllocatorTrace_Op_REALLOC,
+    // arg is the alignment
+    AllocatorTrace_Op_ALLOC_ALIGNED
+}
+AllocatorTrace_Op;
+
+typedef struct
+{
+    // position of the record in the trace plus 1, 0 while it is written
+    size_t      seq;
+    uint64_t    timestamp;
+    // the address returned, NULL if the request failed, or the one freed
+    uintptr_t   ptr;
+    size_t      size;
+    uintptr_t   arg;
+    uint32_t    op;
+}
+AllocatorTrace_Record;
+
+typedef struct
+{
+    AllocatorTrace_Record*  records;
+    // a power of two
+    size_t                  capacity;
+    // number of records claimed so far, only accessed atomically
+    size_t                  head;
+}
+AllocatorTrace_Ring;
+
+// returns the timestamp of a record, in any unit the caller likes
+typedef uint64_t
+(*AllocatorTrace_ClockT)(void);
+
+struct AllocatorTrace
+{
+    Allocator               parent;
+    Allocator*              impl;
+    AllocatorTrace_Ring*    ring;
+    AllocatorTrace_ClockT   clock;
+};
+
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported dynamic functions ----------------------------------------------- */
+/* Exported static functions -------------------------------------------------*/
+
+// records must hold capacity entries, capacity must be a power of two
+bool
+AllocatorTrace_Ring_ctor(AllocatorTrace_Ring*   self,
+                         AllocatorTrace_Record* records,
+                         size_t                 capacity);
+
+/**
+ * @brief copies the records following the ones read before, oldest first
+ *
+ * @param self pointer to the ring
+ * @param next position in the trace of the next record to read, 0 for the
+ *  first call. It is advanced past the records copied and moves over the
+ *  ones overwritten in the meantime, leaving a gap in their seq numbers
+ * @param records output array
+ * @param num number of entries in records
+ *
+ * @return the number of records copied, it stops at the first record that is
+ *  still being written
+ */
+size_t
+AllocatorTrace_Ring_read(AllocatorTrace_Ring*   self,
+                         size_t*                next,
+                         AllocatorTrace_Record* records,
+                         size_t                 num);
+
+// clock may be NULL, the timestamps are then 0
+bool
+AllocatorTrace_ctor(AllocatorTrace*         self,
+                    Allocator*              impl,
+                    AllocatorTrace_Ring*    ring,
+                    AllocatorTrace_ClockT   clock);
+
+void*
+AllocatorTrace_alloc(Allocator* allocator, size_t size);
+
+void*
+AllocatorTrace_allocAligned(Allocator* allocator,
+                            size_t size,
+                            size_t alignment);
+
+void
+AllocatorTrace_free(Allocator* allocator, void* ptr);
+
+// the blocks of a batch are recorded one by one
+size_t
+AllocatorTrace_allocBatch(Allocator* allocator,
+                          size_t size,
+                          void** ptrs,
+                          size_t num);
+
+void
+AllocatorTrace_freeBatch(Allocator* allocator, void** ptrs, size_t num);
+
+void*
+AllocatorTrace_realloc(Allocator* allocator, void* ptr, size_t size);
+
+size_t
+AllocatorTrace_usableSize(Allocator* allocator, void* ptr);
+
+void
+AllocatorTrace_dtor(Allocator* allocator);
+
+///@}
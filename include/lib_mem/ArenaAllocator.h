@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+*/
+
+/**
+ * @addtogroup lib_mem
+ * @{
+ *
+ * @file ArenaAllocator.h
+ *
+ * @brief a bump allocator whose blocks are all given back at once
+ *
+ * Allocations move a pointer forward in the buffer, Allocator_free() does
+ * nothing. ArenaAllocator_release() drops everything allocated after a mark
+ * and ArenaAllocator_reset() drops everything. Each block is preceded by its
+ * size, so that it can be reallocated.
+ *
+ * With a chunk allocator the arena grows by chunks of at least the size of
+ * its buffer taken from it when the buffer is full, they are given back by
+ * the release that drops them.
+ */
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/Allocator.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Exported macro ------------------------------------------------------------*/
+
+#define ArenaAllocator_TO_ALLOCATOR(self)  (&(self)->parent)
+
+/* Exported types ------------------------------------------------------------*/
+
+typedef struct ArenaAllocator_Chunk ArenaAllocator_Chunk;
+
+struct ArenaAllocator_Chunk
+{
+    ArenaAllocator_Chunk*   prev;
+    size_t                  size;
+};
+
+typedef struct
+{
+    ArenaAllocator_Chunk*   chunk;
+    uint8_t*                top;
+}
+ArenaAllocator_Mark;
+
+typedef struct ArenaAllocator ArenaAllocator;
+
+struct ArenaAllocator
+{
+    Allocator               parent;
+    uint8_t*                buffer;
+    size_t                  size;
+    // may be NULL, the arena does not grow then
+    Allocator*              chunkAllocator;
+    // chunk the allocations come from, NULL for the buffer
+    ArenaAllocator_Chunk*   chunk;
+    uint8_t*                top;
+    uint8_t*                limit;
+    bool                    isStatic;
+};
+
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported dynamic functions ----------------------------------------------- */
+/* Exported static functions -------------------------------------------------*/
+
+#if !defined(Memory_Config_STATIC)
+bool
+ArenaAllocator_ctor(ArenaAllocator* self,
+                    size_t size,
+                    Allocator* chunkAllocator);
+#endif
+
+bool
+ArenaAllocator_ctorStatic(ArenaAllocator* self,
+                          void* buffer,
+                          size_t size,
+                          Allocator* chunkAllocator);
+
+// the blocks are aligned like the ones of Memory_alloc()
+void*
+ArenaAllocator_alloc(Allocator* allocator, size_t size);
+
+void*
+ArenaAllocator_allocAligned(Allocator* allocator,
+                            size_t size,
+                            size_t alignment);
+
+// does nothing, see ArenaAllocator_release()
+void
+ArenaAllocator_free(Allocator* allocator, void* ptr);
+
+// the most recent block grows and shrinks in place, the others shrink in
+// place and move when they grow, to a block aligned like the ones of
+// ArenaAllocator_alloc()
+void*
+ArenaAllocator_realloc(Allocator* allocator, void* ptr, size_t size);
+
+size_t
+ArenaAllocator_usableSize(Allocator* allocator, void* ptr);
+
+ArenaAllocator_Mark
+ArenaAllocator_mark(ArenaAllocator* self);
+
+// drops the blocks allocated after the mark was taken, the marks taken after
+// it become invalid
+void
+ArenaAllocator_release(ArenaAllocator* self, ArenaAllocator_Mark mark);
+
+void
+ArenaAllocator_reset(ArenaAllocator* self);
+
+// gives the chunks back
+void
+ArenaAllocator_dtor(Allocator* allocator);
+
+///@}
@@ -30,14 +30,87 @@
 
 #define BitmapAllocator_TO_ALLOCATOR(self)  (&(self)->parent)
 
+#define BitmapAllocator_BITS_IN_A_SLOT\
+    (sizeof(BitmapAllocator_BitmapSlot) * CHAR_BIT)
+
+// the bitmaps are scanned a whole BitmapAllocator_BitmapSlot at a time, so
+// their size is rounded up to a multiple of the slot size
 #define BitmapAllocator_BITMAP_SIZE(NUM_EL)\
-    ((NUM_EL) / CHAR_BIT + ((NUM_EL) % CHAR_BIT ? 1 : 0))
+    ((((NUM_EL) + BitmapAllocator_BITS_IN_A_SLOT - 1)\
+      / BitmapAllocator_BITS_IN_A_SLOT) * sizeof(BitmapAllocator_BitmapSlot))
+
+// the optional summary bitmap has one bit per slot of the bitmap, the bit is
+// set when all the elements of that slot are allocated
+#define BitmapAllocator_SUMMARY_SIZE(NUM_EL)\
+    BitmapAllocator_BITMAP_SIZE(BitmapAllocator_BITMAP_SIZE(NUM_EL)\
+                                / sizeof(BitmapAllocator_BitmapSlot))
+
+// number of buckets of the free run histogram
+#define BitmapAllocator_FREE_RUN_BUCKETS    (sizeof(size_t) * CHAR_BIT)
 
 /* Exported types ------------------------------------------------------------*/
 
 typedef struct BitmapAllocator BitmapAllocator;
 typedef BitmapInt BitmapAllocator_BitmapSlot;
 
+typedef enum
+{
+    // every search starts at the beginning of the pool
+    BitmapAllocator_Policy_FIRST_FIT = 0,
+    // a search starts where the previous allocation ended and wraps around
+    BitmapAllocator_Policy_NEXT_FIT
+}
+BitmapAllocator_Policy;
+
+typedef enum
+{
+    // the fastest kernel supported by the CPU, chosen at construction
+    BitmapAllocator_Kernel_AUTO = 0,
+    BitmapAllocator_Kernel_SCALAR,
+    // x86-64 only
+    BitmapAllocator_Kernel_SSE2,
+    BitmapAllocator_Kernel_AVX2
+}
+BitmapAllocator_Kernel;
+
+// returns the first slot in [slot, endSlot) that is not fully busy, or endSlot
+typedef size_t
+(*BitmapAllocator_SkipFullT)(const BitmapAllocator_BitmapSlot* bitmap,
+                             size_t slot,
+                             size_t endSlot);
+
+// collected only when Memory_Config_BITMAP_ALLOCATOR_STATS is defined
+typedef struct
+{
+    size_t allocCount;
+    size_t freeCount;
+    size_t failedAllocCount;
+    // largest number of elements allocated at the same time
+    size_t highWaterMark;
+    // bitmap words read by all the searches and by the longest one
+    size_t scannedWords;
+    size_t maxScannedWords;
+    // consumedElements * elementSize - requestedBytes is the memory lost to
+    // the rounding of the successful requests to whole elements
+    size_t requestedBytes;
+    size_t consumedElements;
+}
+BitmapAllocator_Stats;
+
+typedef struct
+{
+    // freeRuns[i] counts the free runs of 2^i to 2^(i+1) - 1 elements
+    size_t      freeRuns[BitmapAllocator_FREE_RUN_BUCKETS];
+    size_t      numFreeRuns;
+    size_t      freeElements;
+    size_t      largestFreeRun;
+    // share of the free elements outside of the largest free run in per mille,
+    // 0 when all the free memory is contiguous
+    unsigned    fragmentation;
+    size_t      liveAllocations;
+}
+BitmapAllocator_Fragmentation;
+
 struct BitmapAllocator
 {
     Allocator                   parent;
@@ -45,8 +118,16 @@ struct BitmapAllocator
     size_t                      elementSize;
     size_t                      numElements;
     size_t                      allocatedElements;
+    // upper bound of the longest run of free elements, requests above it
+    // fail without scanning the bitmap
+    size_t                      maxFreeRun;
+    BitmapAllocator_Policy      policy;
+    size_t                      cursor;
     BitmapAllocator_BitmapSlot* bitmap;
     BitmapAllocator_BitmapSlot* boundaryBitmap;
+    BitmapAllocator_BitmapSlot* summaryBitmap;
+    BitmapAllocator_SkipFullT   skipFullSlots;
+    BitmapAllocator_Stats       stats;
     bool                        isStatic;
 };
 
@@ -62,6 +143,18 @@ bool
 BitmapAllocator_ctor(BitmapAllocator* self,
                      size_t elementSize,
                      size_t numElements);
+
+bool
+BitmapAllocator_ctorWithPolicy(BitmapAllocator* self,
+                               size_t elementSize,
+                               size_t numElements,
+                               BitmapAllocator_Policy policy);
+
+bool
+BitmapAllocator_ctorWithSummary(BitmapAllocator* self,
+                                size_t elementSize,
+                                size_t numElements,
+                                BitmapAllocator_Policy policy);
 #endif
 
 bool
@@ -72,12 +165,73 @@ BitmapAllocator_ctorStatic(BitmapAllocator* self,
                            size_t elementSize,
                            size_t numElements);
 
+bool
+BitmapAllocator_ctorStaticWithPolicy(BitmapAllocator* self,
+                                     void* buffer,
+                                     void* bitmap,
+                                     void* boundaryBitmap,
+                                     size_t elementSize,
+                                     size_t numElements,
+                                     BitmapAllocator_Policy policy);
+
+// summaryBitmap may be NULL, otherwise it must be zero initialised like the
+// other bitmaps and hold BitmapAllocator_SUMMARY_SIZE(numElements) bytes
+bool
+BitmapAllocator_ctorStaticWithSummary(BitmapAllocator* self,
+                                      void* buffer,
+                                      void* bitmap,
+                                      void* boundaryBitmap,
+                                      void* summaryBitmap,
+                                      size_t elementSize,
+                                      size_t numElements,
+                                      BitmapAllocator_Policy policy);
+
+// selects the kernel skipping fully busy slots when there is no summary
+// bitmap, fails if the CPU does not support it
+bool
+BitmapAllocator_setKernel(BitmapAllocator* self,
+                          BitmapAllocator_Kernel kernel);
+
 void*
 BitmapAllocator_alloc(Allocator* allocator, size_t size);
 
+// only tries the elements whose address is a multiple of alignment, in
+// first-fit order whatever the policy
+void*
+BitmapAllocator_allocAligned(Allocator* allocator,
+                             size_t size,
+                             size_t alignment);
+
 void
 BitmapAllocator_free(Allocator* allocator, void* ptr);
 
+size_t
+BitmapAllocator_allocBatch(Allocator* allocator,
+                           size_t size,
+                           void** ptrs,
+                           size_t num);
+
+void
+BitmapAllocator_freeBatch(Allocator* allocator, void** ptrs, size_t num);
+
+// grows or shrinks the block in place when the following elements allow it
+void*
+BitmapAllocator_realloc(Allocator* allocator, void* ptr, size_t size);
+
+size_t
+BitmapAllocator_usableSize(Allocator* allocator, void* ptr);
+
+// walks the bitmaps once to describe the free space, it does not lock so when
+// the allocator is wrapped by an AllocatorSafe the caller has to hold its mutex
+void
+BitmapAllocator_getFragmentation(BitmapAllocator* self,
+                                 BitmapAllocator_Fragmentation* report);
+
+// copies the statistics into stats, returns false if they are not collected
+bool
+BitmapAllocator_getStats(const BitmapAllocator* self,
+                         BitmapAllocator_Stats* stats);
+
 #if !defined(Memory_Config_STATIC)
 void
 BitmapAllocator_dtor(Allocator* allocator);
@@ -0,0 +1,283 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+*/
+
+/**
+ * @addtogroup lib_mem
+ * @{
+ *
+ * @file BitmapAllocator_Static.h
+ *
+ * @brief bitmap based pools whose element size and number of elements are
+ *  known at compile time
+ *
+ * BitmapAllocator_DEFINE_STATIC() defines the storage of a pool together with
+ * inline alloc/free functions. As the sizes are constants the compiler turns
+ * the divisions by a power-of-two element size into shifts and all the loop
+ * bounds into constants, and no constructor has to run. The pool follows the
+ * first-fit policy and does not go through the Allocator vtable.
+ *
+ * Usage, in a single translation unit:
+ *
+ *      BitmapAllocator_DEFINE_STATIC(MsgPool, 64, 1024)
+ *
+ *      void* msg = MsgPool_alloc(100);
+ *      MsgPool_free(msg);
+ */
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/BitmapAllocator.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Exported macro ------------------------------------------------------------*/
+
+#define BitmapAllocator_NUM_SLOTS(NUM_EL)\
+    (((NUM_EL) + BitmapAllocator_BITS_IN_A_SLOT - 1)\
+     / BitmapAllocator_BITS_IN_A_SLOT)
+
+// the largest power of two dividing the element size, so that every element
+// is aligned like the buffer, capped to a page
+#define BitmapAllocator_ELEMENT_ALIGNMENT(ELEM_SIZE)\
+    (((ELEM_SIZE) & -(ELEM_SIZE)) < 4096 ? ((ELEM_SIZE) & -(ELEM_SIZE)) : 4096)
+
+#define BitmapAllocator_DEFINE_STATIC(name, ELEM_SIZE, NUM_EL)\
+    static uint8_t name##_buffer[(ELEM_SIZE) * (NUM_EL)]\
+        __attribute__((aligned(BitmapAllocator_ELEMENT_ALIGNMENT(ELEM_SIZE))));\
+    static BitmapAllocator_BitmapSlot\
+        name##_bitmap[BitmapAllocator_NUM_SLOTS(NUM_EL)];\
+    static BitmapAllocator_BitmapSlot\
+        name##_boundaryBitmap[BitmapAllocator_NUM_SLOTS(NUM_EL)];\
+    static size_t name##_allocatedElements;\
+    \
+    INLINE void*\
+    name##_alloc(size_t size)\
+    {\
+        return BitmapAllocator_Static_alloc(name##_buffer,\
+                                            name##_bitmap,\
+                                            name##_boundaryBitmap,\
+                                            &name##_allocatedElements,\
+                                            (ELEM_SIZE),\
+                                            (NUM_EL),\
+                                            size);\
+    }\
+    \
+    INLINE void\
+    name##_free(void* ptr)\
+    {\
+        BitmapAllocator_Static_free(name##_buffer,\
+                                    name##_bitmap,\
+                                    name##_boundaryBitmap,\
+                                    &name##_allocatedElements,\
+                                    (ELEM_SIZE),\
+                                    (NUM_EL),\
+                                    ptr);\
+    }\
+    \
+    INLINE size_t\
+    name##_getAllocatedElements(void)\
+    {\
+        return name##_allocatedElements;\
+    }
+
+/* Exported types ------------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+/* Exported dynamic functions ----------------------------------------------- */
+/* Exported static functions -------------------------------------------------*/
+
+// the functions below are meant to be called with constant sizes through the
+// ones defined by BitmapAllocator_DEFINE_STATIC()
+
+INLINE size_t
+BitmapAllocator_Static_ctz(BitmapAllocator_BitmapSlot word)
+{
+    return (sizeof(word) <= sizeof(unsigned int)) ? __builtin_ctz(word)
+           : (sizeof(word) <= sizeof(unsigned long)) ? __builtin_ctzl(word)
+           : __builtin_ctzll(word);
+}
+
+INLINE BitmapAllocator_BitmapSlot
+BitmapAllocator_Static_rangeMask(size_t offset, size_t count)
+{
+    return ((count < BitmapAllocator_BITS_IN_A_SLOT)
+            ? (((BitmapAllocator_BitmapSlot) 1 << count) - 1)
+            : (BitmapAllocator_BitmapSlot) ~((BitmapAllocator_BitmapSlot) 0))
+           << offset;
+}
+
+// returns the first element of the first run of numNeeded free elements or
+// numElements if there is none
+INLINE size_t
+BitmapAllocator_Static_findFreeRun(const BitmapAllocator_BitmapSlot* bitmap,
+                                   size_t numElements,
+                                   size_t numNeeded)
+{
+    const BitmapAllocator_BitmapSlot full =
+        (BitmapAllocator_BitmapSlot) ~((BitmapAllocator_BitmapSlot) 0);
+    size_t amount = 0;
+    size_t needle = 0;
+
+    for (size_t slot = 0; slot < BitmapAllocator_NUM_SLOTS(numElements); slot++)
+    {
+        BitmapAllocator_BitmapSlot busy = bitmap[slot];
+
+        if (numElements / BitmapAllocator_BITS_IN_A_SLOT == slot)
+        {
+            // the bits past the last element are never free
+            busy |= full << (numElements % BitmapAllocator_BITS_IN_A_SLOT);
+        }
+
+        size_t offset = 0;
+
+        while (offset < BitmapAllocator_BITS_IN_A_SLOT)
+        {
+            BitmapAllocator_BitmapSlot rest = busy >> offset;
+            size_t freeRun = rest ? BitmapAllocator_Static_ctz(rest)
+                             : BitmapAllocator_BITS_IN_A_SLOT - offset;
+            if (freeRun)
+            {
+                needle = amount
+                         ? needle
+                         : slot * BitmapAllocator_BITS_IN_A_SLOT + offset;
+                amount += freeRun;
+                if (amount >= numNeeded)
+                {
+                    return needle;
+                }
+                offset += freeRun;
+            }
+            if (offset < BitmapAllocator_BITS_IN_A_SLOT)
+            {
+                BitmapAllocator_BitmapSlot freeBits =
+                    (BitmapAllocator_BitmapSlot) ~(busy >> offset);
+                offset += freeBits ? BitmapAllocator_Static_ctz(freeBits)
+                          : BitmapAllocator_BITS_IN_A_SLOT - offset;
+                amount = 0;
+            }
+        }
+    }
+    return numElements;
+}
+
+INLINE void*
+BitmapAllocator_Static_alloc(uint8_t* buffer,
+                             BitmapAllocator_BitmapSlot* bitmap,
+                             BitmapAllocator_BitmapSlot* boundaryBitmap,
+                             size_t* allocatedElements,
+                             size_t elementSize,
+                             size_t numElements,
+                             size_t size)
+{
+    void* retval = NULL;
+    size_t numNeeded = size / elementSize + ((size % elementSize) ? 1 : 0);
+    size_t elementNum = numElements;
+
+    if (!size || numNeeded > numElements - *allocatedElements)
+    {
+        // can not fit
+    }
+    else if ((elementNum = BitmapAllocator_Static_findFreeRun(bitmap,
+                                                               numElements,
+                                                               numNeeded))
+             >= numElements)
+    {
+        // no free run is long enough
+    }
+    else
+    {
+        size_t slot      = elementNum / BitmapAllocator_BITS_IN_A_SLOT;
+        size_t offset    = elementNum % BitmapAllocator_BITS_IN_A_SLOT;
+        size_t remaining = numNeeded;
+        size_t last      = elementNum + numNeeded - 1;
+
+        while (remaining)
+        {
+            size_t count = BitmapAllocator_BITS_IN_A_SLOT - offset;
+            count = (remaining < count) ? remaining : count;
+
+            bitmap[slot] |= BitmapAllocator_Static_rangeMask(offset, count);
+
+            remaining  -= count;
+            offset      = 0;
+            slot++;
+        }
+        Bitmap_SET_BIT(boundaryBitmap[last / BitmapAllocator_BITS_IN_A_SLOT],
+                       last % BitmapAllocator_BITS_IN_A_SLOT);
+
+        *allocatedElements += numNeeded;
+
+        retval = buffer + elementNum * elementSize;
+    }
+    return retval;
+}
+
+INLINE void
+BitmapAllocator_Static_free(uint8_t* buffer,
+                            BitmapAllocator_BitmapSlot* bitmap,
+                            BitmapAllocator_BitmapSlot* boundaryBitmap,
+                            size_t* allocatedElements,
+                            size_t elementSize,
+                            size_t numElements,
+                            void* ptr)
+{
+    uint8_t* addr = (uint8_t*) ptr;
+    // integer arithmetic, ptr may be NULL or outside the buffer
+    size_t elementNum = ((uintptr_t) ptr - (uintptr_t) buffer) / elementSize;
+
+    if (NULL == ptr)
+    {
+        // do nothing
+    }
+    else if (addr < buffer
+             || addr >= buffer + numElements * elementSize
+             || !Bitmap_GET_BIT(bitmap[elementNum
+                                       / BitmapAllocator_BITS_IN_A_SLOT],
+                                elementNum % BitmapAllocator_BITS_IN_A_SLOT))
+    {
+        Debug_LOG_WARNING("%s: ptr @%p was not allocated!", __func__, ptr);
+    }
+    else
+    {
+        size_t slot   = elementNum / BitmapAllocator_BITS_IN_A_SLOT;
+        size_t offset = elementNum % BitmapAllocator_BITS_IN_A_SLOT;
+
+        // find the boundary of the allocation
+        BitmapAllocator_BitmapSlot boundaries =
+            boundaryBitmap[slot] & BitmapAllocator_Static_rangeMask(
+                offset, BitmapAllocator_BITS_IN_A_SLOT - offset);
+
+        while (!boundaries)
+        {
+            boundaries = boundaryBitmap[++slot];
+        }
+        size_t last = slot * BitmapAllocator_BITS_IN_A_SLOT
+                      + BitmapAllocator_Static_ctz(boundaries);
+        size_t remaining = last - elementNum + 1;
+
+        *allocatedElements -= remaining;
+        Bitmap_CLR_BIT(boundaryBitmap[slot],
+                       last % BitmapAllocator_BITS_IN_A_SLOT);
+
+        slot = elementNum / BitmapAllocator_BITS_IN_A_SLOT;
+        while (remaining)
+        {
+            size_t count = BitmapAllocator_BITS_IN_A_SLOT - offset;
+            count = (remaining < count) ? remaining : count;
+
+            bitmap[slot] &= ~BitmapAllocator_Static_rangeMask(offset, count);
+
+            remaining  -= count;
+            offset      = 0;
+            slot++;
+        }
+    }
+}
+
+///@}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+*/
+
+/**
+ * @addtogroup lib_mem
+ * @{
+ *
+ * @file CachingAllocator.h
+ *
+ * @brief an allocator keeping per-thread magazines of blocks in front of
+ *  another allocator
+ *
+ * Requests up to the largest size class are served from a magazine of the
+ * calling thread holding blocks of that class. An empty magazine is refilled
+ * with Allocator_allocBatch() and a full one gives half of its blocks back
+ * with Allocator_freeBatch(), so with an AllocatorSafe behind it the mutex is
+ * taken once per batch. Larger requests go straight to the backing allocator.
+ *
+ * Every block starts with a small header holding its size class, a block may
+ * thus be freed by any thread and ends up in the magazine of that thread.
+ * A thread has to call CachingAllocator_flushThread() before it exits and
+ * all of them before the allocator is destroyed, otherwise the blocks in its
+ * magazines are lost.
+ */
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/Allocator.h"
+
+#include <stddef.h>
+
+/* Exported macro ------------------------------------------------------------*/
+
+#define CachingAllocator_TO_ALLOCATOR(self)  (&(self)->parent)
+
+/* Exported types ------------------------------------------------------------*/
+
+typedef struct CachingAllocator CachingAllocator;
+
+struct CachingAllocator
+{
+    Allocator       parent;
+    Allocator*      backing;
+    // usable sizes of the blocks of each class, in ascending order
+    const size_t*   classSizes;
+    size_t          numClasses;
+    // blocks held by a magazine at most, refills and flushes move half of it
+    size_t          magazineSize;
+};
+
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported dynamic functions ----------------------------------------------- */
+/* Exported static functions -------------------------------------------------*/
+
+// classSizes must stay valid as long as the allocator is used, magazineSize
+// must be at least 2
+bool
+CachingAllocator_ctor(CachingAllocator* self,
+                      Allocator* backing,
+                      const size_t* classSizes,
+                      size_t numClasses,
+                      size_t magazineSize);
+
+void*
+CachingAllocator_alloc(Allocator* allocator, size_t size);
+
+void
+CachingAllocator_free(Allocator* allocator, void* ptr);
+
+size_t
+CachingAllocator_usableSize(Allocator* allocator, void* ptr);
+
+// gives all the blocks cached by the calling thread back to the backing
+// allocator
+void
+CachingAllocator_flushThread(CachingAllocator* self);
+
+// flushes the calling thread only
+void
+CachingAllocator_dtor(Allocator* allocator);
+
+///@}
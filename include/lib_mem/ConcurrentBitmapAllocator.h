@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+*/
+
+/**
+ * @addtogroup lib_mem
+ * @{
+ *
+ * @file ConcurrentBitmapAllocator.h
+ *
+ * @brief a thread safe bitmap based allocator, lock free for single elements
+ *
+ * The bitmaps have the layout of the ones of BitmapAllocator. Requests of a
+ * single element claim a bit with an atomic compare-and-swap on its bitmap
+ * slot, requests of several elements are serialized by a mutex and claim their
+ * range slot by slot with compare-and-swap too, so that they never take
+ * elements claimed meanwhile by the lock free path. An allocation claims its
+ * elements before it sets its boundary bit, a free clears the boundary bit
+ * before it releases the elements. Frees never take the mutex.
+ */
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/Allocator.h"
+#include "lib_mem/BitmapAllocator.h"
+#include "lib_osal/Mutex.h"
+
+#include <stddef.h>
+
+/* Exported macro ------------------------------------------------------------*/
+
+#define ConcurrentBitmapAllocator_TO_ALLOCATOR(self)  (&(self)->parent)
+
+/* Exported types ------------------------------------------------------------*/
+
+typedef struct ConcurrentBitmapAllocator ConcurrentBitmapAllocator;
+
+struct ConcurrentBitmapAllocator
+{
+    Allocator                   parent;
+    void*                       baseAddr;
+    size_t                      elementSize;
+    size_t                      numElements;
+    // only accessed atomically
+    size_t                      allocatedElements;
+    // slot where the next single element search starts, only accessed
+    // atomically
+    size_t                      hint;
+    BitmapAllocator_BitmapSlot* bitmap;
+    BitmapAllocator_BitmapSlot* boundaryBitmap;
+    // serializes the requests of several elements
+    Mutex*                      mutex;
+    bool                        isStatic;
+};
+
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported dynamic functions ----------------------------------------------- */
+/* Exported static functions -------------------------------------------------*/
+
+#if !defined(Memory_Config_STATIC)
+bool
+ConcurrentBitmapAllocator_ctor(ConcurrentBitmapAllocator* self,
+                               size_t elementSize,
+                               size_t numElements,
+                               Mutex* mutex);
+#endif
+
+// the bitmaps must be zero initialised and hold
+// BitmapAllocator_BITMAP_SIZE(numElements) bytes each
+bool
+ConcurrentBitmapAllocator_ctorStatic(ConcurrentBitmapAllocator* self,
+                                     void* buffer,
+                                     void* bitmap,
+                                     void* boundaryBitmap,
+                                     size_t elementSize,
+                                     size_t numElements,
+                                     Mutex* mutex);
+
+void*
+ConcurrentBitmapAllocator_alloc(Allocator* allocator, size_t size);
+
+void
+ConcurrentBitmapAllocator_free(Allocator* allocator, void* ptr);
+
+size_t
+ConcurrentBitmapAllocator_usableSize(Allocator* allocator, void* ptr);
+
+void
+ConcurrentBitmapAllocator_dtor(Allocator* allocator);
+
+///@}
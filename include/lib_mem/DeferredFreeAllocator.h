@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+*/
+
+/**
+ * @addtogroup lib_mem
+ * @{
+ *
+ * @file DeferredFreeAllocator.h
+ *
+ * @brief an allocator owned by one thread which the other threads may free
+ *  blocks to without a lock
+ *
+ * Only the owner thread allocates, it works on the wrapped allocator directly.
+ * A free from another thread pushes the block on a lock free list, using its
+ * first bytes as the link. Smaller requests are rounded up to
+ * DeferredFreeAllocator_MIN_BLOCK_SIZE bytes so that every block can hold it,
+ * the blocks need not be aligned for a pointer. The owner gives the blocks of
+ * the list back to the wrapped allocator at its next allocation or when it
+ * calls DeferredFreeAllocator_drain().
+ */
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/Allocator.h"
+
+#include <stddef.h>
+
+/* Exported macro ------------------------------------------------------------*/
+
+#define DeferredFreeAllocator_TO_ALLOCATOR(self)  (&(self)->parent)
+
+// the size of the link of the pending list
+#define DeferredFreeAllocator_MIN_BLOCK_SIZE      sizeof(void*)
+
+/* Exported types ------------------------------------------------------------*/
+
+typedef struct DeferredFreeAllocator DeferredFreeAllocator;
+
+struct DeferredFreeAllocator
+{
+    Allocator   parent;
+    Allocator*  impl;
+    // identifies the owner thread, see DeferredFreeAllocator_setOwner()
+    const void* owner;
+    // blocks freed by the other threads, only accessed atomically
+    void*       pending;
+};
+
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported dynamic functions ----------------------------------------------- */
+/* Exported static functions -------------------------------------------------*/
+
+// the calling thread becomes the owner
+bool
+DeferredFreeAllocator_ctor(DeferredFreeAllocator* self,
+                           Allocator* impl);
+
+// hands the allocator over to the calling thread, the previous owner must not
+// use it any more
+void
+DeferredFreeAllocator_setOwner(DeferredFreeAllocator* self);
+
+// owner thread only
+void*
+DeferredFreeAllocator_alloc(Allocator* allocator, size_t size);
+
+void
+DeferredFreeAllocator_free(Allocator* allocator, void* ptr);
+
+// owner thread only
+size_t
+DeferredFreeAllocator_usableSize(Allocator* allocator, void* ptr);
+
+// owner thread only, returns the number of blocks given back
+size_t
+DeferredFreeAllocator_drain(DeferredFreeAllocator* self);
+
+// owner thread only, drains the pending blocks
+void
+DeferredFreeAllocator_dtor(Allocator* allocator);
+
+///@}
@@ -54,4 +54,70 @@ Memory_free(void* ptr)
 
 #   endif // [not] defined(Memory_Config_USE_STDLIB_ALLOC_INLINE)
 
-#endif // defined(Memory_Config_USE_STDLIB_ALLOC)
+#elif defined(Memory_Config_USE_ALLOCATOR)
+
+// The heap is the Allocator* given by Memory_Config_ALLOCATOR, the config file
+// has to declare it. If Memory_Config_ALLOCATOR_IMPL names its type, e.g.
+// BitmapAllocator or TlsfAllocator, alloc and free call the functions of that
+// type directly instead of going through the vtable. That only saves the
+// indirect call, the functions are defined in their .c file and are not
+// inlined without LTO. The heap itself must be built with a ctorStatic, its
+// dynamic ctor would call Memory_alloc().
+
+#include "lib_mem/Allocator.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#   if !defined(Memory_Config_ALLOCATOR)
+#       error Memory_Config_ALLOCATOR must give the Allocator* of the heap
+#   endif
+
+#   if defined(Memory_Config_ALLOCATOR_IMPL)
+#       define MEMORY_IMPL_FN(impl, fn)     MEMORY_IMPL_FN_(impl, fn)
+#       define MEMORY_IMPL_FN_(impl, fn)    impl ## _ ## fn
+#       define MEMORY_IMPL_ALLOC\
+    MEMORY_IMPL_FN(Memory_Config_ALLOCATOR_IMPL, alloc)
+#       define MEMORY_IMPL_FREE\
+    MEMORY_IMPL_FN(Memory_Config_ALLOCATOR_IMPL, free)
+#   else
+#       define MEMORY_IMPL_ALLOC            Allocator_alloc
+#       define MEMORY_IMPL_FREE             Allocator_free
+#   endif
+
+INLINE void*
+Memory_alloc(size_t size)
+{
+    return MEMORY_IMPL_ALLOC(Memory_Config_ALLOCATOR, size);
+}
+
+INLINE void*
+Memory_calloc(size_t nmemb, size_t size)
+{
+    void* retval = NULL;
+
+    if (size && nmemb > SIZE_MAX / size)
+    {
+        // do nothing
+    }
+    else if ((retval = Memory_alloc(nmemb * size)) != NULL)
+    {
+        memset(retval, 0, nmemb * size);
+    }
+    return retval;
+}
+
+// not every allocator has its own realloc, it goes through the vtable
+INLINE void*
+Memory_realloc(void* ptr, size_t size)
+{
+    return Allocator_realloc(Memory_Config_ALLOCATOR, ptr, size);
+}
+
+INLINE void
+Memory_free(void* ptr)
+{
+    MEMORY_IMPL_FREE(Memory_Config_ALLOCATOR, ptr);
+}
+
+#endif // defined(Memory_Config_USE_STDLIB_ALLOC), Memory_Config_USE_ALLOCATOR
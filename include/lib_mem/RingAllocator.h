@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+*/
+
+/**
+ * @addtogroup lib_mem
+ * @{
+ *
+ * @file RingAllocator.h
+ *
+ * @brief an allocator for blocks freed in about the order of their allocation
+ *
+ * Blocks are allocated one after the other at the head of a ring buffer and
+ * the space is reclaimed at its tail. A block never wraps around the end of
+ * the buffer, if it does not fit there it starts at the beginning and the end
+ * is left unused until the tail passes it. A block freed before the older
+ * ones is only marked in a pending mask, its space is reclaimed together with
+ * theirs. Each block has a header holding its sequence number, so alloc and
+ * free take constant time. At most RingAllocator_MAX_BLOCKS blocks may be
+ * allocated at a time.
+ */
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/Allocator.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Exported macro ------------------------------------------------------------*/
+
+#define RingAllocator_TO_ALLOCATOR(self)  (&(self)->parent)
+
+// bits in the pending mask
+#define RingAllocator_MAX_BLOCKS    64
+
+/* Exported types ------------------------------------------------------------*/
+
+typedef struct RingAllocator RingAllocator;
+
+struct RingAllocator
+{
+    Allocator   parent;
+    uint8_t*    buffer;
+    size_t      size;
+    // offsets of the next block and of the oldest allocated one
+    size_t      head;
+    size_t      tail;
+    // sequence numbers of the next block and of the oldest allocated one
+    size_t      headSeq;
+    size_t      tailSeq;
+    // bit n is set when block tailSeq + n was freed
+    uint64_t    pending;
+    // offset of each allocated block, indexed by its sequence number
+    size_t      offsets[RingAllocator_MAX_BLOCKS];
+    bool        isStatic;
+};
+
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported dynamic functions ----------------------------------------------- */
+/* Exported static functions -------------------------------------------------*/
+
+#if !defined(Memory_Config_STATIC)
+bool
+RingAllocator_ctor(RingAllocator* self,
+                   size_t size);
+#endif
+
+bool
+RingAllocator_ctorStatic(RingAllocator* self,
+                         void* buffer,
+                         size_t size);
+
+// the blocks are aligned like the ones of Memory_alloc()
+void*
+RingAllocator_alloc(Allocator* allocator, size_t size);
+
+void
+RingAllocator_free(Allocator* allocator, void* ptr);
+
+size_t
+RingAllocator_usableSize(Allocator* allocator, void* ptr);
+
+void
+RingAllocator_dtor(Allocator* allocator);
+
+///@}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+*/
+
+/**
+ * @addtogroup lib_mem
+ * @{
+ *
+ * @file ShardedAllocator.h
+ *
+ * @brief a thread safe allocator spreading the threads over several bitmap
+ *  based arenas, each with its own mutex
+ *
+ * Every thread gets a home arena assigned round robin on its first request.
+ * An allocation skips the arenas that are busy or can not serve it and moves
+ * the home of the thread to the arena that did, it only waits for a mutex when
+ * all the arenas were busy. A free finds the arena owning the block with a
+ * binary search over the address ranges of the arenas, which are kept sorted
+ * by their base address.
+ */
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/Allocator.h"
+#include "lib_mem/BitmapAllocator.h"
+#include "lib_osal/Mutex.h"
+
+#include <stddef.h>
+
+/* Exported macro ------------------------------------------------------------*/
+
+#define ShardedAllocator_TO_ALLOCATOR(self)  (&(self)->parent)
+
+/* Exported types ------------------------------------------------------------*/
+
+typedef struct
+{
+    BitmapAllocator bmAllocator;
+    Mutex*          mutex;
+    // set while a thread holds the mutex, only accessed atomically
+    bool            busy;
+}
+ShardedAllocator_Arena;
+
+typedef struct ShardedAllocator ShardedAllocator;
+
+struct ShardedAllocator
+{
+    Allocator               parent;
+    // sorted by base address
+    ShardedAllocator_Arena* arenas;
+    size_t                  numArenas;
+    // next home arena to hand out, only accessed atomically
+    size_t                  nextHome;
+    bool                    isStatic;
+};
+
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported dynamic functions ----------------------------------------------- */
+/* Exported static functions -------------------------------------------------*/
+
+#if !defined(Memory_Config_STATIC)
+// creates a pool of numElements elements in each of the numArenas arenas,
+// mutexes holds one mutex per arena
+bool
+ShardedAllocator_ctor(ShardedAllocator* self,
+                      ShardedAllocator_Arena* arenas,
+                      size_t numArenas,
+                      size_t elementSize,
+                      size_t numElements,
+                      Mutex** mutexes);
+#endif
+
+// the bmAllocator and mutex of every arena are set up by the caller, the
+// arenas must not overlap and may be reordered
+bool
+ShardedAllocator_ctorStatic(ShardedAllocator* self,
+                            ShardedAllocator_Arena* arenas,
+                            size_t numArenas);
+
+void*
+ShardedAllocator_alloc(Allocator* allocator, size_t size);
+
+void
+ShardedAllocator_free(Allocator* allocator, void* ptr);
+
+size_t
+ShardedAllocator_usableSize(Allocator* allocator, void* ptr);
+
+// destroys the pools created by ShardedAllocator_ctor(), the mutexes are left
+// to the caller
+void
+ShardedAllocator_dtor(Allocator* allocator);
+
+///@}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+*/
+
+/**
+ * @addtogroup lib_mem
+ * @{
+ *
+ * @file SizeClassAllocator.h
+ *
+ * @brief an allocator passing each request to the pool of its size class
+ *
+ * The classes are given as a table sorted by maxSize. A request goes to the
+ * first class whose maxSize covers it, requests above the last class and the
+ * ones a full class pool can not serve go to the fallback allocator. A free
+ * goes to the class whose address range holds the block, or to the fallback
+ * if there is none. The class allocators are typically SlabAllocator or
+ * BitmapAllocator instances whose element size matches the class, the table
+ * and everything it points to may be static.
+ */
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/Allocator.h"
+
+#include <stddef.h>
+
+/* Exported macro ------------------------------------------------------------*/
+
+#define SizeClassAllocator_TO_ALLOCATOR(self)  (&(self)->parent)
+
+/* Exported types ------------------------------------------------------------*/
+
+typedef struct
+{
+    // largest request served by the class
+    size_t      maxSize;
+    Allocator*  allocator;
+    // the memory the blocks of allocator come from
+    void*       base;
+    size_t      size;
+}
+SizeClassAllocator_Class;
+
+typedef struct SizeClassAllocator SizeClassAllocator;
+
+struct SizeClassAllocator
+{
+    Allocator                       parent;
+    const SizeClassAllocator_Class* classes;
+    size_t                          numClasses;
+    // may be NULL, larger requests fail then
+    Allocator*                      fallback;
+};
+
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported dynamic functions ----------------------------------------------- */
+/* Exported static functions -------------------------------------------------*/
+
+// the table must stay valid as long as the allocator is used, its maxSize are
+// strictly ascending and its address ranges do not overlap
+bool
+SizeClassAllocator_ctor(SizeClassAllocator* self,
+                        const SizeClassAllocator_Class* classes,
+                        size_t numClasses,
+                        Allocator* fallback);
+
+void*
+SizeClassAllocator_alloc(Allocator* allocator, size_t size);
+
+void*
+SizeClassAllocator_allocAligned(Allocator* allocator,
+                                size_t size,
+                                size_t alignment);
+
+void
+SizeClassAllocator_free(Allocator* allocator, void* ptr);
+
+size_t
+SizeClassAllocator_usableSize(Allocator* allocator, void* ptr);
+
+// the class allocators and the fallback are left to the caller
+void
+SizeClassAllocator_dtor(Allocator* allocator);
+
+///@}
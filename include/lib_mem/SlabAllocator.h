@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+*/
+
+/**
+ * @addtogroup lib_mem
+ * @{
+ *
+ * @file SlabAllocator.h
+ *
+ * @brief an allocator of fixed size slots with constant time alloc and free
+ *
+ * The free slots form a list linked through their first bytes, so a slot must
+ * be able to hold a pointer. The slots that were never allocated are not on
+ * the list, they are handed out from the end of the used part of the buffer,
+ * so the construction does not touch the buffer. There is no way to tell an
+ * allocated slot from a free one, freeing a slot twice corrupts the list.
+ */
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/Allocator.h"
+
+#include <stddef.h>
+
+/* Exported macro ------------------------------------------------------------*/
+
+#define SlabAllocator_TO_ALLOCATOR(self)  (&(self)->parent)
+
+/* Exported types ------------------------------------------------------------*/
+
+typedef struct SlabAllocator SlabAllocator;
+
+struct SlabAllocator
+{
+    Allocator   parent;
+    void*       baseAddr;
+    size_t      slotSize;
+    size_t      numSlots;
+    size_t      allocatedSlots;
+    // slots below it have been handed out at least once
+    size_t      usedSlots;
+    void*       freeList;
+    bool        isStatic;
+};
+
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported dynamic functions ----------------------------------------------- */
+/* Exported static functions -------------------------------------------------*/
+
+#if !defined(Memory_Config_STATIC)
+bool
+SlabAllocator_ctor(SlabAllocator* self,
+                   size_t slotSize,
+                   size_t numSlots);
+#endif
+
+// buffer must hold numSlots * slotSize bytes, slotSize at least sizeof(void*)
+bool
+SlabAllocator_ctorStatic(SlabAllocator* self,
+                         void* buffer,
+                         size_t slotSize,
+                         size_t numSlots);
+
+// fails for sizes above the slot size
+void*
+SlabAllocator_alloc(Allocator* allocator, size_t size);
+
+void
+SlabAllocator_free(Allocator* allocator, void* ptr);
+
+size_t
+SlabAllocator_usableSize(Allocator* allocator, void* ptr);
+
+void
+SlabAllocator_dtor(Allocator* allocator);
+
+///@}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+*/
+
+/**
+ * @addtogroup lib_mem
+ * @{
+ *
+ * @file TlsfAllocator.h
+ *
+ * @brief a two level segregated fit allocator, alloc and free take a bounded
+ *  time whatever the size and the fragmentation of the pool
+ *
+ * The free blocks are kept in lists by size class. The first level splits the
+ * sizes by powers of two, the second level splits each of those ranges in
+ * TlsfAllocator_SL_COUNT linear steps. A bitmap per level tells which lists are
+ * not empty, so a list with blocks large enough is found with two find first
+ * set operations. A free merges the block with its free neighbours right
+ * away, they are reached through the header of every block.
+ *
+ * The blocks are aligned to TlsfAllocator_ALIGN_SIZE bytes, each of them
+ * costs a header of the same size.
+ */
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/Allocator.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Exported macro ------------------------------------------------------------*/
+
+#define TlsfAllocator_TO_ALLOCATOR(self)  (&(self)->parent)
+
+#define TlsfAllocator_ALIGN_SIZE    (2 * sizeof(void*))
+#define TlsfAllocator_ALIGN_LOG2    ((sizeof(void*) == 8) ? 4 : 3)
+
+#define TlsfAllocator_SL_LOG2       4
+#define TlsfAllocator_SL_COUNT      (1 << TlsfAllocator_SL_LOG2)
+// blocks are smaller than 2^TlsfAllocator_FL_MAX bytes
+#define TlsfAllocator_FL_MAX        ((sizeof(size_t) == 8) ? 32 : 30)
+// sizes below 2^TlsfAllocator_FL_SHIFT all go to the first level list 0
+#define TlsfAllocator_FL_SHIFT\
+    (TlsfAllocator_SL_LOG2 + TlsfAllocator_ALIGN_LOG2)
+#define TlsfAllocator_FL_COUNT\
+    (TlsfAllocator_FL_MAX - TlsfAllocator_FL_SHIFT + 1)
+
+/* Exported types ------------------------------------------------------------*/
+
+typedef struct TlsfAllocator_Block TlsfAllocator_Block;
+
+typedef struct TlsfAllocator TlsfAllocator;
+
+struct TlsfAllocator
+{
+    Allocator               parent;
+    void*                   baseAddr;
+    size_t                  size;
+    // bytes the blocks offer, without the headers
+    size_t                  usedBytes;
+    size_t                  freeBytes;
+    uint32_t                flBitmap;
+    uint32_t                slBitmaps[TlsfAllocator_FL_COUNT];
+    TlsfAllocator_Block*    freeLists[TlsfAllocator_FL_COUNT]
+                                     [TlsfAllocator_SL_COUNT];
+};
+
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported dynamic functions ----------------------------------------------- */
+/* Exported static functions -------------------------------------------------*/
+
+// the pool lives in the buffer, which needs room for at least three headers
+bool
+TlsfAllocator_ctorStatic(TlsfAllocator* self,
+                         void* buffer,
+                         size_t size);
+
+void*
+TlsfAllocator_alloc(Allocator* allocator, size_t size);
+
+void
+TlsfAllocator_free(Allocator* allocator, void* ptr);
+
+// shrinks or grows the block in place when the next one is free
+void*
+TlsfAllocator_realloc(Allocator* allocator, void* ptr, size_t size);
+
+size_t
+TlsfAllocator_usableSize(Allocator* allocator, void* ptr);
+
+size_t
+TlsfAllocator_getUsedBytes(const TlsfAllocator* self);
+
+size_t
+TlsfAllocator_getFreeBytes(const TlsfAllocator* self);
+
+void
+TlsfAllocator_dtor(Allocator* allocator);
+
+///@}
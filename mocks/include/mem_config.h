@@ -15,3 +15,6 @@
 
 // Use the stdlib alloc
 #define Memory_Config_USE_STDLIB_ALLOC
+
+// Collect the BitmapAllocator statistics
+#define Memory_Config_BITMAP_ALLOCATOR_STATS
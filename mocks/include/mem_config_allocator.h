@@ -0,0 +1,24 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+*/
+
+/**
+ * @file
+ *
+ * @brief Memory configuration with a BitmapAllocator as the heap, used by
+ *  Test_Memory.cpp
+ */
+#pragma once
+
+#include "lib_mem/BitmapAllocator.h"
+
+extern BitmapAllocator Test_Memory_heap;
+
+// Use a static BitmapAllocator as the heap, called directly
+#define Memory_Config_USE_ALLOCATOR
+#define Memory_Config_ALLOCATOR         BitmapAllocator_TO_ALLOCATOR(&Test_Memory_heap)
+#define Memory_Config_ALLOCATOR_IMPL    BitmapAllocator
@@ -15,9 +15,14 @@
 
 static const Allocator_Vtable AllocatorSafe_vtable =
 {
-    .alloc      = AllocatorSafe_alloc,
-    .free       = AllocatorSafe_free,
-    .dtor       = AllocatorSafe_dtor
+    .alloc        = AllocatorSafe_alloc,
+    .free         = AllocatorSafe_free,
+    .dtor         = AllocatorSafe_dtor,
+    .allocBatch   = AllocatorSafe_allocBatch,
+    .freeBatch    = AllocatorSafe_freeBatch,
+    .realloc      = AllocatorSafe_realloc,
+    .usableSize   = AllocatorSafe_usableSize,
+    .allocAligned = AllocatorSafe_allocAligned
 };
 
 /* Public functions ----------------------------------------------------------*/
@@ -60,6 +65,25 @@ AllocatorSafe_alloc(Allocator* allocator, size_t size)
     return retval;
 }
 
+void*
+AllocatorSafe_allocAligned(Allocator* allocator,
+                           size_t size,
+                           size_t alignment)
+{
+    AllocatorSafe* self = (AllocatorSafe*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    void* retval = NULL;
+
+    Mutex_acquire(self->mutex);
+
+    retval = Allocator_allocAligned(self->impl, size, alignment);
+
+    Mutex_release(self->mutex);
+
+    return retval;
+}
+
 void
 AllocatorSafe_free(Allocator* allocator, void* ptr)
 {
@@ -73,6 +97,73 @@ AllocatorSafe_free(Allocator* allocator, void* ptr)
     Mutex_release(self->mutex);
 }
 
+size_t
+AllocatorSafe_allocBatch(Allocator* allocator,
+                         size_t size,
+                         void** ptrs,
+                         size_t num)
+{
+    AllocatorSafe* self = (AllocatorSafe*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    size_t retval = 0;
+
+    Mutex_acquire(self->mutex);
+
+    retval = Allocator_allocBatch(self->impl, size, ptrs, num);
+
+    Mutex_release(self->mutex);
+
+    return retval;
+}
+
+void
+AllocatorSafe_freeBatch(Allocator* allocator, void** ptrs, size_t num)
+{
+    AllocatorSafe* self = (AllocatorSafe*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    Mutex_acquire(self->mutex);
+
+    Allocator_freeBatch(self->impl, ptrs, num);
+
+    Mutex_release(self->mutex);
+}
+
+void*
+AllocatorSafe_realloc(Allocator* allocator, void* ptr, size_t size)
+{
+    AllocatorSafe* self = (AllocatorSafe*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    void* retval = NULL;
+
+    Mutex_acquire(self->mutex);
+
+    retval = Allocator_realloc(self->impl, ptr, size);
+
+    Mutex_release(self->mutex);
+
+    return retval;
+}
+
+size_t
+AllocatorSafe_usableSize(Allocator* allocator, void* ptr)
+{
+    AllocatorSafe* self = (AllocatorSafe*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    size_t retval = 0;
+
+    Mutex_acquire(self->mutex);
+
+    retval = Allocator_usableSize(self->impl, ptr);
+
+    Mutex_release(self->mutex);
+
+    return retval;
+}
+
 void
 AllocatorSafe_dtor(Allocator* stream)
 {
@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "lib_mem/AllocatorTrace.h"
+
+/* Defines -------------------------------------------------------------------*/
+/* Private functions prototypes ----------------------------------------------*/
+
+static void
+record(AllocatorTrace* self,
+       AllocatorTrace_Op op,
+       void* ptr,
+       size_t size,
+       uintptr_t arg);
+
+/* Private variables ---------------------------------------------------------*/
+
+static const Allocator_Vtable AllocatorTrace_vtable =
+{
+    .alloc        = AllocatorTrace_alloc,
+    .free         = AllocatorTrace_free,
+    .dtor         = AllocatorTrace_dtor,
+    .allocBatch   = AllocatorTrace_allocBatch,
+    .freeBatch    = AllocatorTrace_freeBatch,
+    .realloc      = AllocatorTrace_realloc,
+    .usableSize   = AllocatorTrace_usableSize,
+    .allocAligned = AllocatorTrace_allocAligned
+};
+
+/* Public functions ----------------------------------------------------------*/
+bool
+AllocatorTrace_Ring_ctor(AllocatorTrace_Ring*   self,
+                         AllocatorTrace_Record* records,
+                         size_t                 capacity)
+{
+    Debug_ASSERT_SELF(self);
+
+    bool retval = true;
+
+    if (NULL == records || !capacity || (capacity & (capacity - 1)))
+    {
+        retval = false;
+    }
+    else
+    {
+        memset(records, 0, capacity * sizeof(*records));
+
+        self->records   = records;
+        self->capacity  = capacity;
+        self->head      = 0;
+    }
+    return retval;
+}
+
+size_t
+AllocatorTrace_Ring_read(AllocatorTrace_Ring*   self,
+                         size_t*                next,
+                         AllocatorTrace_Record* records,
+                         size_t                 num)
+{
+    Debug_ASSERT_SELF(self);
+    Debug_ASSERT(NULL != next);
+    Debug_ASSERT(NULL != records || !num);
+
+    size_t count = 0;
+
+    while (count < num)
+    {
+        size_t head = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+
+        if (*next >= head)
+        {
+            break;
+        }
+        if (head - *next > self->capacity)
+        {
+            // overwritten before we got to them
+            *next = head - self->capacity;
+        }
+
+        AllocatorTrace_Record* rec =
+            &self->records[*next & (self->capacity - 1)];
+        size_t seq = __atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE);
+
+        if (seq < *next + 1)
+        {
+            // still being written
+            break;
+        }
+        memcpy(&records[count], rec, sizeof(*rec));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        // a writer that has lapped us may have changed the record while we
+        // copied it, the next round then skips ahead
+        if (seq == *next + 1
+            && __atomic_load_n(&rec->seq, __ATOMIC_RELAXED) == seq)
+        {
+            records[count].seq = seq;
+            count++;
+            (*next)++;
+        }
+    }
+    return count;
+}
+
+bool
+AllocatorTrace_ctor(AllocatorTrace*         self,
+                    Allocator*              impl,
+                    AllocatorTrace_Ring*    ring,
+                    AllocatorTrace_ClockT   clock)
+{
+    Debug_ASSERT_SELF(self);
+
+    bool retval = true;
+
+    if (NULL == impl || NULL == ring)
+    {
+        retval = false;
+    }
+    else
+    {
+        self->impl  = impl;
+        self->ring  = ring;
+        self->clock = clock;
+        self->parent.vtable = &AllocatorTrace_vtable;
+    }
+    return retval;
+}
+
+void*
+AllocatorTrace_alloc(Allocator* allocator, size_t size)
+{
+    AllocatorTrace* self = (AllocatorTrace*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    void* retval = Allocator_alloc(self->impl, size);
+
+    record(self, AllocatorTrace_Op_ALLOC, retval, size, 0);
+
+    return retval;
+}
+
+void*
+AllocatorTrace_allocAligned(Allocator* allocator,
+                            size_t size,
+                            size_t alignment)
+{
+    AllocatorTrace* self = (AllocatorTrace*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    void* retval = Allocator_allocAligned(self->impl, size, alignment);
+
+    record(self, AllocatorTrace_Op_ALLOC_ALIGNED, retval, size, alignment);
+
+    return retval;
+}
+
+void
+AllocatorTrace_free(Allocator* allocator, void* ptr)
+{
+    AllocatorTrace* self = (AllocatorTrace*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    // recorded first, the block may be handed out again as soon as it is
+    // freed and its alloc must not precede this record
+    record(self, AllocatorTrace_Op_FREE, ptr, 0, 0);
+
+    Allocator_free(self->impl, ptr);
+}
+
+size_t
+AllocatorTrace_allocBatch(Allocator* allocator,
+                          size_t size,
+                          void** ptrs,
+                          size_t num)
+{
+    AllocatorTrace* self = (AllocatorTrace*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    size_t retval = Allocator_allocBatch(self->impl, size, ptrs, num);
+
+    for (size_t i = 0; i < retval; i++)
+    {
+        record(self, AllocatorTrace_Op_ALLOC, ptrs[i], size, 0);
+    }
+    if (retval < num)
+    {
+        record(self, AllocatorTrace_Op_ALLOC, NULL, size, 0);
+    }
+    return retval;
+}
+
+void
+AllocatorTrace_freeBatch(Allocator* allocator, void** ptrs, size_t num)
+{
+    AllocatorTrace* self = (AllocatorTrace*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    for (size_t i = 0; i < num; i++)
+    {
+        record(self, AllocatorTrace_Op_FREE, ptrs[i], 0, 0);
+    }
+    Allocator_freeBatch(self->impl, ptrs, num);
+}
+
+void*
+AllocatorTrace_realloc(Allocator* allocator, void* ptr, size_t size)
+{
+    AllocatorTrace* self = (AllocatorTrace*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    void* retval = Allocator_realloc(self->impl, ptr, size);
+
+    record(self, AllocatorTrace_Op_REALLOC, retval, size, (uintptr_t) ptr);
+
+    return retval;
+}
+
+size_t
+AllocatorTrace_usableSize(Allocator* allocator, void* ptr)
+{
+    AllocatorTrace* self = (AllocatorTrace*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    return Allocator_usableSize(self->impl, ptr);
+}
+
+void
+AllocatorTrace_dtor(Allocator* allocator)
+{
+    Debug_ASSERT_SELF(allocator);
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+
+static void
+record(AllocatorTrace* self,
+       AllocatorTrace_Op op,
+       void* ptr,
+       size_t size,
+       uintptr_t arg)
+{
+    AllocatorTrace_Ring* ring = self->ring;
+    size_t pos = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED);
+    AllocatorTrace_Record* rec = &ring->records[pos & (ring->capacity - 1)];
+
+    // readers ignore the record until its seq is set again
+    __atomic_store_n(&rec->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    rec->timestamp  = (self->clock != NULL) ? self->clock() : 0;
+    rec->ptr        = (uintptr_t) ptr;
+    rec->size       = size;
+    rec->arg        = arg;
+    rec->op         = op;
+
+    __atomic_store_n(&rec->seq, pos + 1, __ATOMIC_RELEASE);
+}
+
+
+///@}
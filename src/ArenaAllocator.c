@@ -0,0 +1,337 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/ArenaAllocator.h"
+#include "lib_debug/Debug.h"
+#include "lib_mem/Memory.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+
+/* Defines -------------------------------------------------------------------*/
+
+#define DEFAULT_ALIGNMENT   _Alignof(max_align_t)
+#define CHUNK_DATA(chunk)   ((uint8_t*) ((chunk) + 1))
+// each block is preceded by its size
+#define SIZE_HEADER         sizeof(size_t)
+
+/* Private functions prototypes ----------------------------------------------*/
+
+// returns the first address from ptr on that is a multiple of alignment, or
+// NULL if it is past limit
+INLINE uint8_t*
+alignUp(uint8_t* ptr, uint8_t* limit, size_t alignment)
+{
+    size_t padding = (alignment - ((uintptr_t) ptr & (alignment - 1)))
+                     & (alignment - 1);
+
+    return (padding <= (size_t) (limit - ptr)) ? ptr + padding : NULL;
+}
+
+// returns the address of a block of size bytes between top and limit with
+// room for its size in front, or NULL if it does not fit
+INLINE uint8_t*
+placeBlock(uint8_t* top, uint8_t* limit, size_t size, size_t alignment)
+{
+    uint8_t* retval = NULL;
+
+    if ((size_t) (limit - top) >= SIZE_HEADER)
+    {
+        retval = alignUp(top + SIZE_HEADER, limit, alignment);
+    }
+    return (retval != NULL && size <= (size_t) (limit - retval))
+           ? retval
+           : NULL;
+}
+
+// the sizes need not be aligned, the blocks may have any alignment
+INLINE size_t
+getSize(const void* ptr)
+{
+    size_t size;
+
+    memcpy(&size, (const uint8_t*) ptr - SIZE_HEADER, sizeof(size));
+    return size;
+}
+
+INLINE void
+setSize(void* ptr, size_t size)
+{
+    memcpy((uint8_t*) ptr - SIZE_HEADER, &size, sizeof(size));
+}
+
+static bool
+addChunk(ArenaAllocator* self, size_t size, size_t alignment);
+
+/* Private variables ---------------------------------------------------------*/
+
+static const Allocator_Vtable ArenaAllocator_vtable =
+{
+    .alloc        = ArenaAllocator_alloc,
+    .free         = ArenaAllocator_free,
+    .dtor         = ArenaAllocator_dtor,
+    .realloc      = ArenaAllocator_realloc,
+    .usableSize   = ArenaAllocator_usableSize,
+    .allocAligned = ArenaAllocator_allocAligned
+};
+
+
+/* Public functions ----------------------------------------------------------*/
+
+#if !defined(Memory_Config_STATIC)
+bool
+ArenaAllocator_ctor(ArenaAllocator* self,
+                    size_t size,
+                    Allocator* chunkAllocator)
+{
+    Debug_ASSERT_SELF(self);
+
+    bool retval = false;
+    void* buffer = Memory_alloc(size);
+
+    if (NULL == buffer)
+    {
+        retval = false;
+    }
+    else
+    {
+        retval = ArenaAllocator_ctorStatic(self, buffer, size, chunkAllocator);
+        self->isStatic = false;
+    }
+    if (!retval)
+    {
+        Memory_free(buffer);
+    }
+    return retval;
+}
+#endif
+
+bool
+ArenaAllocator_ctorStatic(ArenaAllocator* self,
+                          void* buffer,
+                          size_t size,
+                          Allocator* chunkAllocator)
+{
+    Debug_ASSERT_SELF(self);
+
+    bool retval = false;
+
+    if (NULL == buffer || !size)
+    {
+        retval = false;
+    }
+    else
+    {
+        memset(self, 0, sizeof(*self));
+
+        self->buffer            = buffer;
+        self->size              = size;
+        self->chunkAllocator    = chunkAllocator;
+        self->chunk             = NULL;
+        self->top               = self->buffer;
+        self->limit             = self->buffer + size;
+        self->isStatic          = true;
+
+        self->parent.vtable = &ArenaAllocator_vtable;
+
+        retval = true;
+    }
+    return retval;
+}
+
+void*
+ArenaAllocator_alloc(Allocator* allocator, size_t size)
+{
+    return ArenaAllocator_allocAligned(allocator, size, DEFAULT_ALIGNMENT);
+}
+
+void*
+ArenaAllocator_allocAligned(Allocator* allocator,
+                            size_t size,
+                            size_t alignment)
+{
+    ArenaAllocator* self = (ArenaAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+    Debug_ASSERT(alignment && !(alignment & (alignment - 1)));
+
+    uint8_t* retval = NULL;
+
+    if (!size)
+    {
+        // do nothing
+    }
+    else if (NULL == (retval = placeBlock(self->top, self->limit, size,
+                                          alignment))
+             && (!addChunk(self, size, alignment)
+                 || NULL == (retval = placeBlock(self->top, self->limit, size,
+                                                 alignment))))
+    {
+        Debug_LOG_WARNING("%s: size %zd, alignment %zd, allocation failed",
+                          __func__, size, alignment);
+    }
+    else
+    {
+        setSize(retval, size);
+        self->top = retval + size;
+    }
+    return retval;
+}
+
+void
+ArenaAllocator_free(Allocator* allocator, void* ptr)
+{
+    Debug_ASSERT_SELF(allocator);
+    (void) ptr;
+}
+
+void*
+ArenaAllocator_realloc(Allocator* allocator, void* ptr, size_t size)
+{
+    ArenaAllocator* self = (ArenaAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    uint8_t* retval = NULL;
+    size_t oldSize = (ptr != NULL) ? getSize(ptr) : 0;
+
+    if (NULL == ptr)
+    {
+        retval = ArenaAllocator_alloc(allocator, size);
+    }
+    else if (!size)
+    {
+        // do nothing, like ArenaAllocator_free()
+    }
+    else if ((uint8_t*) ptr + oldSize == self->top
+             && size <= (size_t) (self->limit - (uint8_t*) ptr))
+    {
+        // the top block grows or shrinks in place
+        setSize(ptr, size);
+        self->top = (uint8_t*) ptr + size;
+        retval = ptr;
+    }
+    else if (size <= oldSize)
+    {
+        // the space behind a lower block is only reclaimed with it
+        setSize(ptr, size);
+        retval = ptr;
+    }
+    else if ((retval = ArenaAllocator_alloc(allocator, size)) != NULL)
+    {
+        memcpy(retval, ptr, oldSize);
+    }
+    return retval;
+}
+
+size_t
+ArenaAllocator_usableSize(Allocator* allocator, void* ptr)
+{
+    Debug_ASSERT_SELF(allocator);
+
+    return (ptr != NULL) ? getSize(ptr) : 0;
+}
+
+ArenaAllocator_Mark
+ArenaAllocator_mark(ArenaAllocator* self)
+{
+    Debug_ASSERT_SELF(self);
+
+    ArenaAllocator_Mark mark = { .chunk = self->chunk, .top = self->top };
+
+    return mark;
+}
+
+void
+ArenaAllocator_release(ArenaAllocator* self, ArenaAllocator_Mark mark)
+{
+    Debug_ASSERT_SELF(self);
+
+    while (self->chunk != mark.chunk)
+    {
+        ArenaAllocator_Chunk* prev = self->chunk;
+
+        Debug_ASSERT(prev != NULL);
+        self->chunk = prev->prev;
+        Allocator_free(self->chunkAllocator, prev);
+    }
+    if (NULL == self->chunk)
+    {
+        self->limit = self->buffer + self->size;
+    }
+    else
+    {
+        self->limit = CHUNK_DATA(self->chunk) + self->chunk->size;
+    }
+    self->top = mark.top;
+}
+
+void
+ArenaAllocator_reset(ArenaAllocator* self)
+{
+    Debug_ASSERT_SELF(self);
+
+    ArenaAllocator_Mark mark = { .chunk = NULL, .top = self->buffer };
+
+    ArenaAllocator_release(self, mark);
+}
+
+void
+ArenaAllocator_dtor(Allocator* allocator)
+{
+    ArenaAllocator* self = (ArenaAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    ArenaAllocator_reset(self);
+#if !defined(Memory_Config_STATIC)
+    if (!self->isStatic)
+    {
+        Memory_free(self->buffer);
+    }
+#endif
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+
+// takes a chunk big enough for the request from the chunk allocator, the rest
+// of the current one is left unused
+static bool
+addChunk(ArenaAllocator* self, size_t size, size_t alignment)
+{
+    bool retval = false;
+    size_t needed = size + SIZE_HEADER + alignment - 1;
+    size_t chunkSize = (needed > self->size) ? needed : self->size;
+    ArenaAllocator_Chunk* chunk = NULL;
+
+    if (NULL == self->chunkAllocator
+        || size > SIZE_MAX - SIZE_HEADER - alignment
+        || chunkSize > SIZE_MAX - sizeof(ArenaAllocator_Chunk))
+    {
+        retval = false;
+    }
+    else if (NULL == (chunk = Allocator_alloc(self->chunkAllocator,
+                                              sizeof(*chunk) + chunkSize)))
+    {
+        retval = false;
+    }
+    else
+    {
+        chunk->prev = self->chunk;
+        chunk->size = chunkSize;
+        self->chunk = chunk;
+        self->top   = CHUNK_DATA(chunk);
+        self->limit = self->top + chunkSize;
+        retval = true;
+    }
+    return retval;
+}
+
+
+///@}
@@ -9,6 +9,7 @@
 /* Includes ------------------------------------------------------------------*/
 
 #include "lib_mem/BitmapAllocator.h"
+#include "BitmapAllocator_Scan.h"
 #include "lib_debug/Debug.h"
 #include "lib_mem/Memory.h"
 #include "lib_logs/Logger.h"
@@ -22,13 +23,18 @@
     (sizeof(BitmapAllocator_BitmapSlot) * CHAR_BIT)
 #define SLOT(self, elementNum) ((elementNum) / BITS_IN_A_BITMAP_SLOT((self)))
 #define OFFSET(self, elementNum) ((elementNum) % BITS_IN_A_BITMAP_SLOT((self)))
+#define NUM_SLOTS(self) (SLOT((self), (self)->numElements - 1) + 1)
+#define NO_ELEMENT(self) ((self)->numElements)
+#define SLOT_FULL ((BitmapAllocator_BitmapSlot) ~((BitmapAllocator_BitmapSlot) 0))
 #define ELEMENT_NUM(self, slot, offset)\
     ((slot) * BITS_IN_A_BITMAP_SLOT((self)) + (offset))
 // precondition is that ptr is within our boundaries
 #define TO_ELEMENT_NUM(self, ptr)\
     (((ptr) - (self)->baseAddr) / (self)->elementSize)
+#define TO_NUM_ELEMENTS(self, size)\
+    ((size) / (self)->elementSize + (((size) % (self)->elementSize) ? 1 : 0))
 #define TO_MEM_ADDR(self, elNum)\
-    (((self)->baseAddr) + elNum * (self)->elementSize)
+    (((self)->baseAddr) + (elNum) * (self)->elementSize)
 
 /* Private functions prototypes ----------------------------------------------*/
 
@@ -94,48 +100,437 @@ isBoundary(BitmapAllocator* self, void* ptr)
     return retval;
 }
 
-INLINE void*
-findContiguousFreeElements(BitmapAllocator* self, size_t numElements)
+INLINE size_t
+countTrailingZeros(BitmapAllocator_BitmapSlot word)
+{
+    Debug_ASSERT(word != 0);
+
+    return (sizeof(word) <= sizeof(unsigned int)) ? __builtin_ctz(word)
+           : (sizeof(word) <= sizeof(unsigned long)) ? __builtin_ctzl(word)
+           : __builtin_ctzll(word);
+}
+
+INLINE size_t
+countLeadingZeros(BitmapAllocator_BitmapSlot word)
+{
+    Debug_ASSERT(word != 0);
+
+    return (sizeof(word) <= sizeof(unsigned int))
+           ? __builtin_clz(word)
+           - (sizeof(unsigned int) - sizeof(word)) * CHAR_BIT
+           : (sizeof(word) <= sizeof(unsigned long))
+           ? __builtin_clzl(word)
+           - (sizeof(unsigned long) - sizeof(word)) * CHAR_BIT
+           : __builtin_clzll(word)
+           - (sizeof(unsigned long long) - sizeof(word)) * CHAR_BIT;
+}
+
+INLINE size_t
+countOnes(BitmapAllocator_BitmapSlot word)
+{
+    return (sizeof(word) <= sizeof(unsigned int)) ? __builtin_popcount(word)
+           : (sizeof(word) <= sizeof(unsigned long)) ? __builtin_popcountl(word)
+           : __builtin_popcountll(word);
+}
+
+// returns floor(log2(value)), value must not be 0
+INLINE size_t
+log2Floor(size_t value)
+{
+    Debug_ASSERT(value != 0);
+
+    return sizeof(size_t) * CHAR_BIT - 1
+           - ((sizeof(size_t) <= sizeof(unsigned long)) ? __builtin_clzl(value)
+              : __builtin_clzll(value));
+}
+
+// returns the busy bits of a bitmap slot, the bits past the last element of
+// the pool are reported as busy so that they never become part of a free run
+INLINE BitmapAllocator_BitmapSlot
+getBusyBits(BitmapAllocator* self, size_t slot)
+{
+    BitmapAllocator_BitmapSlot busy = self->bitmap[slot];
+
+    if (SLOT(self, self->numElements) == slot)
+    {
+        busy |= SLOT_FULL << OFFSET(self, self->numElements);
+    }
+    return busy;
+}
+
+// returns the first slot at or after 'slot' that is not fully busy according
+// to the summary bitmap, or endSlot if there is none before it
+INLINE size_t
+skipFullSlots(BitmapAllocator* self, size_t slot, size_t endSlot)
 {
+    Debug_ASSERT(self->summaryBitmap != NULL);
+
+    size_t summarySlot = SLOT(self, slot);
+    BitmapAllocator_BitmapSlot notFull =
+        ~self->summaryBitmap[summarySlot] & (SLOT_FULL << OFFSET(self, slot));
+
+    while (!notFull)
+    {
+        if (ELEMENT_NUM(self, ++summarySlot, 0) >= endSlot)
+        {
+            return endSlot;
+        }
+        notFull = ~self->summaryBitmap[summarySlot];
+    }
+    slot = ELEMENT_NUM(self, summarySlot, countTrailingZeros(notFull));
+
+    return (slot < endSlot) ? slot : endSlot;
+}
+
+INLINE size_t
+maxOf(size_t a, size_t b)
+{
+    return (a > b) ? a : b;
+}
+
+INLINE size_t
+minOf(size_t a, size_t b)
+{
+    return (a < b) ? a : b;
+}
+
+// the statistics helpers below are empty unless
+// Memory_Config_BITMAP_ALLOCATOR_STATS is defined, so that collecting them
+// costs nothing when they are not wanted
+INLINE void
+statsScanned(BitmapAllocator* self, size_t numSlots)
+{
+#if defined(Memory_Config_BITMAP_ALLOCATOR_STATS)
+    self->stats.scannedWords += numSlots;
+#endif
+}
+
+// returns the value to pass to statsAllocated() or statsFailed() once the
+// search is over
+INLINE size_t
+statsScanStart(BitmapAllocator* self)
+{
+#if defined(Memory_Config_BITMAP_ALLOCATOR_STATS)
+    return self->stats.scannedWords;
+#else
+    return 0;
+#endif
+}
+
+INLINE void
+statsHighWater(BitmapAllocator* self)
+{
+#if defined(Memory_Config_BITMAP_ALLOCATOR_STATS)
+    self->stats.highWaterMark = maxOf(self->stats.highWaterMark,
+                                      self->allocatedElements);
+#endif
+}
+
+INLINE void
+statsSearched(BitmapAllocator* self, size_t scanStart)
+{
+#if defined(Memory_Config_BITMAP_ALLOCATOR_STATS)
+    self->stats.maxScannedWords = maxOf(self->stats.maxScannedWords,
+                                        self->stats.scannedWords - scanStart);
+#endif
+}
+
+INLINE void
+statsAllocated(BitmapAllocator* self,
+               size_t size,
+               size_t numElements,
+               size_t scanStart)
+{
+#if defined(Memory_Config_BITMAP_ALLOCATOR_STATS)
+    self->stats.allocCount++;
+    self->stats.requestedBytes   += size;
+    self->stats.consumedElements += numElements;
+    statsSearched(self, scanStart);
+    statsHighWater(self);
+#endif
+}
+
+INLINE void
+statsFailed(BitmapAllocator* self, size_t scanStart)
+{
+#if defined(Memory_Config_BITMAP_ALLOCATOR_STATS)
+    self->stats.failedAllocCount++;
+    statsSearched(self, scanStart);
+#endif
+}
+
+INLINE void
+statsFreed(BitmapAllocator* self)
+{
+#if defined(Memory_Config_BITMAP_ALLOCATOR_STATS)
+    self->stats.freeCount++;
+#endif
+}
+
+// looks for the first run of free elements that starts at or after
+// firstElement and ends before the slot endSlot, returns its first element
+// number or NO_ELEMENT(self) if there is none. When nothing is found
+// largestRun receives an upper bound of the longest free run scanned
+INLINE size_t
+findFreeRun(BitmapAllocator* self,
+            size_t firstElement,
+            size_t endSlot,
+            size_t numElements,
+            size_t* largestRun)
+{
+    const size_t bitsInSlot = BITS_IN_A_BITMAP_SLOT(self);
     size_t amount = 0;
-    size_t needle = -1;
+    size_t needle = 0;
+    size_t largest = 0;
 
-    for (size_t slot = 0; slot <= SLOT(self, self->numElements); slot++)
+    for (size_t slot = SLOT(self, firstElement); slot < endSlot; slot++)
     {
-        for (size_t offset = 0;
-             offset < BITS_IN_A_BITMAP_SLOT(self);
-             offset++)
+        size_t nextSlot =
+            (self->summaryBitmap != NULL)
+            ? skipFullSlots(self, slot, endSlot)
+            : (SLOT_FULL == self->bitmap[slot])
+            ? self->skipFullSlots(self->bitmap, slot + 1, endSlot)
+            : slot;
+
+        // the summary bitmap skips the busy slots without reading them
+        statsScanned(self,
+                     (self->summaryBitmap != NULL) ? 1 : 1 + nextSlot - slot);
+
+        if (nextSlot != slot)
         {
-            size_t elementNum = ELEMENT_NUM(self, slot, offset);
+            // all the skipped slots are busy
+            amount  = 0;
+            slot    = nextSlot;
+            if (slot >= endSlot)
+            {
+                break;
+            }
+        }
+
+        BitmapAllocator_BitmapSlot busy = getBusyBits(self, slot);
+
+        if (SLOT(self, firstElement) == slot)
+        {
+            // the elements before firstElement must not be part of the run
+            busy |= ~(SLOT_FULL << OFFSET(self, firstElement));
+        }
 
-            if (elementNum >= self->numElements)
+        if (SLOT_FULL == busy)
+        {
+            amount = 0;
+        }
+        else if (0 == busy)
+        {
+            needle = amount ? needle : ELEMENT_NUM(self, slot, 0);
+            amount += bitsInSlot;
+            if (amount >= numElements)
             {
-                return NULL; // out of range
+                return needle;
             }
-            else if (!Bitmap_GET_BIT(self->bitmap[slot], offset))
+            largest = maxOf(largest, amount);
+        }
+        else if (numElements > bitsInSlot)
+        {
+            // a run longer than a slot can only pass through a mixed slot at
+            // its edges: the low free bits may complete the current run and
+            // the high free bits may start a new one
+            amount += countTrailingZeros(busy);
+            if (amount >= numElements)
             {
-                //Debug_LOG_TRACE("%s: free at slot %zd offset %zd",
-                //                __func__, slot, offset);
-                needle = ((-1 == needle) ? elementNum : needle);
-                if (++amount >= numElements)
-                {
-                    //Debug_LOG_TRACE("%s: found with needle %zu",
-                    //                __func__, needle);
-                    return TO_MEM_ADDR(self, needle);
-                }
-                // else do nothing
+                return needle;
             }
-            else
+            // the runs inside the slot are not measured, but they are
+            // shorter than a slot
+            largest = maxOf(largest, maxOf(amount, bitsInSlot - 1));
+            amount = countLeadingZeros(busy);
+            needle = ELEMENT_NUM(self, slot, bitsInSlot - amount);
+            largest = maxOf(largest, amount);
+        }
+        else
+        {
+            size_t offset = 0;
+
+            while (offset < bitsInSlot)
             {
-                //Debug_LOG_TRACE("%s: busy at slot %zd offset %zd",
-                //                __func__, slot, offset);
-                amount = 0;
-                needle = -1;
+                BitmapAllocator_BitmapSlot rest = busy >> offset;
+                size_t freeRun = rest ? countTrailingZeros(rest)
+                                 : bitsInSlot - offset;
+                if (freeRun)
+                {
+                    needle = amount ? needle : ELEMENT_NUM(self, slot, offset);
+                    amount += freeRun;
+                    if (amount >= numElements)
+                    {
+                        return needle;
+                    }
+                    largest = maxOf(largest, amount);
+                    offset += freeRun;
+                }
+                if (offset < bitsInSlot)
+                {
+                    // the inverted word is never 0, the bits shifted in
+                    // from the top become 1
+                    offset += countTrailingZeros(~(busy >> offset));
+                    amount = 0;
+                }
             }
         }
     }
-    return NULL;
+    *largestRun = largest;
+    return NO_ELEMENT(self);
+}
+
+INLINE void*
+findContiguousFreeElements(BitmapAllocator* self, size_t numElements)
+{
+    size_t elementNum = NO_ELEMENT(self);
+    size_t largestRun = 0;
+
+    if (numElements > self->numElements - self->allocatedElements
+        || numElements > self->maxFreeRun)
+    {
+        // can not fit, no need to scan
+    }
+    else if (BitmapAllocator_Policy_NEXT_FIT == self->policy)
+    {
+        elementNum = findFreeRun(self,
+                                 self->cursor,
+                                 NUM_SLOTS(self),
+                                 numElements,
+                                 &largestRun);
+        if (NO_ELEMENT(self) == elementNum)
+        {
+            // wrap around, a run starting before the cursor ends before the
+            // element cursor + numElements
+            size_t endSlot = SLOT(self, self->cursor + numElements - 1) + 1;
+            endSlot = minOf(endSlot, NUM_SLOTS(self));
+
+            elementNum = findFreeRun(self, 0, endSlot, numElements, &largestRun);
+        }
+        if (NO_ELEMENT(self) == elementNum)
+        {
+            // the two passes may have cut the run around the cursor in two,
+            // so only the failed request size is a safe bound
+            self->maxFreeRun = numElements - 1;
+        }
+    }
+    else
+    {
+        elementNum = findFreeRun(self,
+                                 0,
+                                 NUM_SLOTS(self),
+                                 numElements,
+                                 &largestRun);
+        if (NO_ELEMENT(self) == elementNum)
+        {
+            self->maxFreeRun = largestRun;
+        }
+    }
+    return (NO_ELEMENT(self) == elementNum) ? NULL
+           : TO_MEM_ADDR(self, elementNum);
+}
+// returns the number of free elements starting at elementNum, at most max
+INLINE size_t
+countFreeElements(BitmapAllocator* self, size_t elementNum, size_t max)
+{
+    size_t slot     = SLOT(self, elementNum);
+    size_t offset   = OFFSET(self, elementNum);
+    size_t count    = 0;
+
+    while (count < max && slot < NUM_SLOTS(self))
+    {
+        BitmapAllocator_BitmapSlot busy = getBusyBits(self, slot) >> offset;
+        statsScanned(self, 1);
+
+        if (busy)
+        {
+            count += countTrailingZeros(busy);
+            break;
+        }
+        count  += BITS_IN_A_BITMAP_SLOT(self) - offset;
+        offset  = 0;
+        slot++;
+    }
+    return minOf(count, max);
+}
+
+// returns the first free element at or after elementNum, or NO_ELEMENT(self)
+INLINE size_t
+findFreeElement(BitmapAllocator* self, size_t elementNum)
+{
+    size_t slot = SLOT(self, elementNum);
+    BitmapAllocator_BitmapSlot free =
+        ~getBusyBits(self, slot) & (SLOT_FULL << OFFSET(self, elementNum));
+
+    statsScanned(self, 1);
+    while (!free)
+    {
+        size_t nextSlot = self->skipFullSlots(self->bitmap,
+                                              slot + 1,
+                                              NUM_SLOTS(self));
+        statsScanned(self, nextSlot - slot);
+        slot = nextSlot;
+        if (slot >= NUM_SLOTS(self))
+        {
+            return NO_ELEMENT(self);
+        }
+        free = ~getBusyBits(self, slot);
+    }
+    return ELEMENT_NUM(self, slot, countTrailingZeros(free));
+}
+
+// the addresses of the elements that are multiples of alignment are the ones
+// of the elements firstElement + k * stride, returns NO_ELEMENT(self) if no
+// element is aligned
+INLINE size_t
+getFirstAlignedElement(BitmapAllocator* self, size_t alignment, size_t* stride)
+{
+    uintptr_t base = (uintptr_t) self->baseAddr;
+    // largest power of two dividing both the element size and the alignment
+    size_t common = minOf(self->elementSize & -self->elementSize, alignment);
+    size_t retval = NO_ELEMENT(self);
+
+    *stride = alignment / common;
+
+    if (!self->elementSize || (base & (common - 1)))
+    {
+        retval = NO_ELEMENT(self);
+    }
+    else if (1 == *stride)
+    {
+        retval = 0;
+    }
+    else
+    {
+        // solve (base + i * elementSize) % alignment == 0, i.e.
+        // i * odd == -base / common modulo stride, where odd is odd and so
+        // has an inverse modulo a power of two (Newton's iteration)
+        size_t odd = self->elementSize / common;
+        size_t inverse = odd;
+
+        for (unsigned i = 0; i < 6; i++)
+        {
+            inverse *= 2 - odd * inverse;
+        }
+        retval = ((0 - base / common) * inverse) & (*stride - 1);
+    }
+    return retval;
 }
+
+// returns a mask of 'count' bits starting at bit 'offset' of a slot
+INLINE BitmapAllocator_BitmapSlot
+getRangeMask(BitmapAllocator* self, size_t offset, size_t count)
+{
+    Debug_ASSERT(count && offset + count <= BITS_IN_A_BITMAP_SLOT(self));
+
+    BitmapAllocator_BitmapSlot mask =
+        (count < BITS_IN_A_BITMAP_SLOT(self))
+        ? (((BitmapAllocator_BitmapSlot) 1 << count) - 1)
+        : SLOT_FULL;
+
+    return mask << offset;
+}
+
 // precondition is that ptr is within our boundaries and not already marked
 // as allocated
 INLINE void
@@ -146,18 +541,30 @@ markBitmapBusy(BitmapAllocator* self, void* ptr, size_t numElements)
     size_t baseElementNum = TO_ELEMENT_NUM(self, ptr);
     Debug_ASSERT(baseElementNum + numElements <= self->numElements);
 
-    for (size_t i = 0; i < numElements; i++)
+    size_t slot         = SLOT(self, baseElementNum);
+    size_t offset       = OFFSET(self, baseElementNum);
+    size_t remaining    = numElements;
+
+    while (remaining)
     {
-        size_t elementNum   = baseElementNum + i;
-        size_t slot         = SLOT(self, elementNum);
-        size_t offset       = OFFSET(self, elementNum);
+        size_t count = BITS_IN_A_BITMAP_SLOT(self) - offset;
+        count = (remaining < count) ? remaining : count;
+
+        BitmapAllocator_BitmapSlot mask = getRangeMask(self, offset, count);
 
-        //Debug_LOG_TRACE("%s: setting bit %d in slot %d",
-        //                __func__, offset, slot);
+        Debug_ASSERT(!(self->bitmap[slot] & mask));
+        Debug_ASSERT(!(self->boundaryBitmap[slot] & mask));
+        self->bitmap[slot] |= mask;
+
+        if (self->summaryBitmap != NULL && SLOT_FULL == getBusyBits(self, slot))
+        {
+            Bitmap_SET_BIT(self->summaryBitmap[SLOT(self, slot)],
+                           OFFSET(self, slot));
+        }
 
-        Debug_ASSERT(!isAllocatedElem(self, elementNum));
-        Debug_ASSERT(!isBoundaryElem(self, elementNum));
-        Bitmap_SET_BIT(self->bitmap[slot], offset);
+        remaining  -= count;
+        offset      = 0;
+        slot++;
     }
     // set the boundary bit
     size_t lastElementNum = baseElementNum + numElements - 1;
@@ -174,17 +581,29 @@ markBitmapFree(BitmapAllocator* self, void* ptr, size_t numElements)
     size_t baseElementNum = TO_ELEMENT_NUM(self, ptr);
     Debug_ASSERT(baseElementNum + numElements <= self->numElements);
 
-    for (size_t i = 0; i < numElements; i++)
+    size_t slot         = SLOT(self, baseElementNum);
+    size_t offset       = OFFSET(self, baseElementNum);
+    size_t remaining    = numElements;
+
+    while (remaining)
     {
-        size_t elementNum   = baseElementNum + i;
-        size_t slot         = SLOT(self, elementNum);
-        size_t offset       = OFFSET(self, elementNum);
+        size_t count = BITS_IN_A_BITMAP_SLOT(self) - offset;
+        count = (remaining < count) ? remaining : count;
+
+        BitmapAllocator_BitmapSlot mask = getRangeMask(self, offset, count);
 
-        //Debug_LOG_TRACE("%s: clearing bit %d in slot %d",
-        //                __func__, offset, slot);
+        Debug_ASSERT((self->bitmap[slot] & mask) == mask);
+        self->bitmap[slot] &= ~mask;
 
-        Debug_ASSERT(isAllocatedElem(self, elementNum));
-        Bitmap_CLR_BIT(self->bitmap[slot], offset);
+        if (self->summaryBitmap != NULL)
+        {
+            Bitmap_CLR_BIT(self->summaryBitmap[SLOT(self, slot)],
+                           OFFSET(self, slot));
+        }
+
+        remaining  -= count;
+        offset      = 0;
+        slot++;
     }
     // reset the boundary bit
     size_t lastElementNum = baseElementNum + numElements - 1;
@@ -201,17 +620,21 @@ findBoundaryOfAllocatedMemory(BitmapAllocator* self, void* ptr)
     size_t elementNum = TO_ELEMENT_NUM(self, ptr);
     Debug_ASSERT(elementNum < self->numElements);
 
-    for (size_t i = elementNum; i < self->numElements; i++)
+    size_t slot = SLOT(self, elementNum);
+    // ignore the boundaries of the allocations placed before ptr
+    BitmapAllocator_BitmapSlot boundaries =
+        self->boundaryBitmap[slot] & (SLOT_FULL << OFFSET(self, elementNum));
+
+    while (!boundaries)
     {
-        //Debug_LOG_TRACE("%s: checking element #%d for boundary flag..",
-        //                __func__, i);
-        if (isBoundaryElem(self, i))
+        if (++slot >= NUM_SLOTS(self))
         {
-            //Debug_LOG_TRACE("%s: boundary flag found!", __func__);
-            return TO_MEM_ADDR(self, i);
+            return NULL;
         }
+        boundaries = self->boundaryBitmap[slot];
     }
-    return NULL;
+    return TO_MEM_ADDR(self,
+                       ELEMENT_NUM(self, slot, countTrailingZeros(boundaries)));
 }
 
 // precondition is that ptr and boundary are within our boundaries
@@ -226,23 +649,113 @@ getNumElements(BitmapAllocator* self, void* ptr, void* boundary)
 }
 
 
-/* Private variables ---------------------------------------------------------*/
+INLINE void
+addFreeRun(BitmapAllocator_Fragmentation* report, size_t length)
+{
+    if (length)
+    {
+        report->freeRuns[log2Floor(length)]++;
+        report->numFreeRuns++;
+        report->freeElements += length;
+        report->largestFreeRun = maxOf(report->largestFreeRun, length);
+    }
+}
 
-static const Allocator_Vtable BitmapAllocator_vtable =
+// precondition is that the elements at ptr have been found free
+INLINE void
+allocateElements(BitmapAllocator* self, void* ptr, size_t numElements)
 {
-    .alloc      = BitmapAllocator_alloc,
-    .free       = BitmapAllocator_free,
-    .dtor       = BitmapAllocator_dtor
-};
+    self->allocatedElements += numElements;
+    markBitmapBusy(self, ptr, numElements);
 
+    // the next-fit search continues right after this allocation
+    self->cursor = TO_ELEMENT_NUM(self, ptr) + numElements;
+    self->cursor = (self->cursor < self->numElements) ? self->cursor : 0;
+}
 
-/* Public functions ----------------------------------------------------------*/
+// precondition is that ptr is the start of an allocation
+INLINE void
+freeElements(BitmapAllocator* self, void* ptr)
+{
+    void* boundary      = findBoundaryOfAllocatedMemory(self, ptr);
+    size_t numElements  = getNumElements(self, ptr, boundary);
+
+    markBitmapFree(self, ptr, numElements);
+    statsFreed(self);
+
+    self->allocatedElements -= numElements;
+    // the freed elements may join the free runs on both of their sides
+    self->maxFreeRun = minOf(2 * self->maxFreeRun + numElements,
+                             self->numElements - self->allocatedElements);
+}
+
+// precondition is that ptr is the start of an allocation of numElements
+// elements, returns false if the elements following it are not free
+INLINE bool
+resizeInPlace(BitmapAllocator* self,
+              void* ptr,
+              size_t numElements,
+              size_t numNeededElements)
+{
+    size_t baseElementNum = TO_ELEMENT_NUM(self, ptr);
+    bool retval = false;
+
+    if (numNeededElements < numElements)
+    {
+        // give back the tail, this also clears the old boundary bit
+        size_t numFreed = numElements - numNeededElements;
+
+        markBitmapFree(self,
+                       TO_MEM_ADDR(self, baseElementNum + numNeededElements),
+                       numFreed);
+        Bitmap_SET_BIT(
+            self->boundaryBitmap[SLOT(self, baseElementNum + numNeededElements - 1)],
+            OFFSET(self, baseElementNum + numNeededElements - 1));
+
+        self->allocatedElements -= numFreed;
+        self->maxFreeRun = minOf(2 * self->maxFreeRun + numFreed,
+                                 self->numElements - self->allocatedElements);
+        retval = true;
+    }
+    else if (baseElementNum + numNeededElements > self->numElements)
+    {
+        retval = false;
+    }
+    else
+    {
+        // look only at the slots the grown block would cover
+        size_t numGrown = numNeededElements - numElements;
+        size_t lastElementNum = baseElementNum + numNeededElements - 1;
+        size_t largestRun = 0;
+
+        if (findFreeRun(self,
+                        baseElementNum + numElements,
+                        SLOT(self, lastElementNum) + 1,
+                        numGrown,
+                        &largestRun) == baseElementNum + numElements)
+        {
+            Bitmap_CLR_BIT(
+                self->boundaryBitmap[SLOT(self, baseElementNum + numElements - 1)],
+                OFFSET(self, baseElementNum + numElements - 1));
+            markBitmapBusy(self,
+                           TO_MEM_ADDR(self, baseElementNum + numElements),
+                           numGrown);
+
+            self->allocatedElements += numGrown;
+            statsHighWater(self);
+            retval = true;
+        }
+    }
+    return retval;
+}
 
 #if !defined(Memory_Config_STATIC)
-bool
-BitmapAllocator_ctor(BitmapAllocator* self,
-                     size_t elementSize,
-                     size_t numElements)
+INLINE bool
+ctorDynamic(BitmapAllocator* self,
+            size_t elementSize,
+            size_t numElements,
+            BitmapAllocator_Policy policy,
+            bool withSummary)
 {
     Debug_ASSERT_SELF(self);
 
@@ -252,28 +765,89 @@ BitmapAllocator_ctor(BitmapAllocator* self,
     void* buffer           = Memory_alloc(numElements * elementSize);
     void* bitmap           = Memory_calloc(1, bitmapSize);
     void* boundaryBitmap   = Memory_calloc(1, bitmapSize);
+    void* summaryBitmap    = withSummary
+                             ? Memory_calloc(1,
+                                             BitmapAllocator_SUMMARY_SIZE(
+                                                 numElements))
+                             : NULL;
 
-    if (NULL == buffer || NULL == bitmap || NULL == boundaryBitmap)
+    if (NULL == buffer
+        || NULL == bitmap
+        || NULL == boundaryBitmap
+        || (withSummary && NULL == summaryBitmap))
     {
         retval = false;
-
-        Memory_free(self->baseAddr);
-        Memory_free((void*) self->bitmap);
-        Memory_free((void*) self->boundaryBitmap);
     }
     else
     {
+        retval = BitmapAllocator_ctorStaticWithSummary(self,
+                                                       buffer,
+                                                       bitmap,
+                                                       boundaryBitmap,
+                                                       summaryBitmap,
+                                                       elementSize,
+                                                       numElements,
+                                                       policy);
         self->isStatic = false;
-
-        retval = BitmapAllocator_ctorStatic(self,
-                                            buffer,
-                                            bitmap,
-                                            boundaryBitmap,
-                                            elementSize,
-                                            numElements);
+    }
+    if (!retval)
+    {
+        Memory_free(buffer);
+        Memory_free(bitmap);
+        Memory_free(boundaryBitmap);
+        Memory_free(summaryBitmap);
     }
     return retval;
 }
+#endif
+
+
+/* Private variables ---------------------------------------------------------*/
+
+static const Allocator_Vtable BitmapAllocator_vtable =
+{
+    .alloc        = BitmapAllocator_alloc,
+    .free         = BitmapAllocator_free,
+    .dtor         = BitmapAllocator_dtor,
+    .allocBatch   = BitmapAllocator_allocBatch,
+    .freeBatch    = BitmapAllocator_freeBatch,
+    .realloc      = BitmapAllocator_realloc,
+    .usableSize   = BitmapAllocator_usableSize,
+    .allocAligned = BitmapAllocator_allocAligned
+};
+
+
+/* Public functions ----------------------------------------------------------*/
+
+#if !defined(Memory_Config_STATIC)
+bool
+BitmapAllocator_ctor(BitmapAllocator* self,
+                     size_t elementSize,
+                     size_t numElements)
+{
+    return BitmapAllocator_ctorWithPolicy(self,
+                                          elementSize,
+                                          numElements,
+                                          BitmapAllocator_Policy_FIRST_FIT);
+}
+
+bool
+BitmapAllocator_ctorWithPolicy(BitmapAllocator* self,
+                               size_t elementSize,
+                               size_t numElements,
+                               BitmapAllocator_Policy policy)
+{
+    return ctorDynamic(self, elementSize, numElements, policy, false);
+}
+
+bool
+BitmapAllocator_ctorWithSummary(BitmapAllocator* self,
+                                size_t elementSize,
+                                size_t numElements,
+                                BitmapAllocator_Policy policy)
+{
+    return ctorDynamic(self, elementSize, numElements, policy, true);
+}
 
 #endif
 
@@ -284,18 +858,59 @@ BitmapAllocator_ctorStatic(BitmapAllocator* self,
                            void* boundaryBitmap,
                            size_t elementSize,
                            size_t numElements)
+{
+    return BitmapAllocator_ctorStaticWithPolicy(self,
+                                                buffer,
+                                                bitmap,
+                                                boundaryBitmap,
+                                                elementSize,
+                                                numElements,
+                                                BitmapAllocator_Policy_FIRST_FIT);
+}
+
+bool
+BitmapAllocator_ctorStaticWithPolicy(BitmapAllocator* self,
+                                     void* buffer,
+                                     void* bitmap,
+                                     void* boundaryBitmap,
+                                     size_t elementSize,
+                                     size_t numElements,
+                                     BitmapAllocator_Policy policy)
+{
+    return BitmapAllocator_ctorStaticWithSummary(self,
+                                                 buffer,
+                                                 bitmap,
+                                                 boundaryBitmap,
+                                                 NULL,
+                                                 elementSize,
+                                                 numElements,
+                                                 policy);
+}
+
+bool
+BitmapAllocator_ctorStaticWithSummary(BitmapAllocator* self,
+                                      void* buffer,
+                                      void* bitmap,
+                                      void* boundaryBitmap,
+                                      void* summaryBitmap,
+                                      size_t elementSize,
+                                      size_t numElements,
+                                      BitmapAllocator_Policy policy)
 {
     Debug_ASSERT_SELF(self);
 
-    Debug_LOG_TRACE("%s: buffer @%p, elementSize %zd, numElements %zd",
-                    __func__, buffer, elementSize, numElements);
+    Debug_LOG_TRACE("%s: buffer @%p, elementSize %zd, numElements %zd, policy %d, summary @%p",
+                    __func__, buffer, elementSize, numElements, policy,
+                    summaryBitmap);
 
     bool retval = false;
 
     if (!numElements
         || NULL == buffer
         || NULL == bitmap
-        || NULL == boundaryBitmap)
+        || NULL == boundaryBitmap
+        || (policy != BitmapAllocator_Policy_FIRST_FIT
+            && policy != BitmapAllocator_Policy_NEXT_FIT))
     {
         retval = false;
     }
@@ -306,8 +921,14 @@ BitmapAllocator_ctorStatic(BitmapAllocator* self,
         self->baseAddr          = buffer;
         self->bitmap            = bitmap;
         self->boundaryBitmap    = boundaryBitmap;
+        self->summaryBitmap     = summaryBitmap;
         self->elementSize       = elementSize;
         self->numElements       = numElements;
+        self->policy            = policy;
+        self->maxFreeRun        = numElements;
+        self->skipFullSlots     = BitmapAllocator_Scan_getKernel(
+                                      BitmapAllocator_Kernel_AUTO);
+        self->isStatic          = true;
 
         self->parent.vtable = &BitmapAllocator_vtable;
 
@@ -316,6 +937,28 @@ BitmapAllocator_ctorStatic(BitmapAllocator* self,
     return retval;
 }
 
+bool
+BitmapAllocator_setKernel(BitmapAllocator* self,
+                          BitmapAllocator_Kernel kernel)
+{
+    Debug_ASSERT_SELF(self);
+
+    bool retval = false;
+    BitmapAllocator_SkipFullT skipFullSlots =
+        BitmapAllocator_Scan_getKernel(kernel);
+
+    if (NULL == skipFullSlots)
+    {
+        retval = false;
+    }
+    else
+    {
+        self->skipFullSlots = skipFullSlots;
+        retval = true;
+    }
+    return retval;
+}
+
 void*
 BitmapAllocator_alloc(Allocator* allocator, size_t size)
 {
@@ -330,12 +973,13 @@ BitmapAllocator_alloc(Allocator* allocator, size_t size)
     }
     else
     {
-        size_t numNeededElements = size / self->elementSize
-                                   + ((size % self->elementSize) ? 1 : 0);
+        size_t numNeededElements = TO_NUM_ELEMENTS(self, size);
+        size_t scanStart = statsScanStart(self);
         foundAddr = findContiguousFreeElements(self, numNeededElements);
 
         if (NULL == foundAddr)
         {
+            statsFailed(self, scanStart);
             Debug_LOG_WARNING("%s: size %zd, allocation failed, allocated %zd out of %zd elements",
                               __func__,
                               size,
@@ -344,8 +988,8 @@ BitmapAllocator_alloc(Allocator* allocator, size_t size)
         }
         else
         {
-            self->allocatedElements += numNeededElements;
-            markBitmapBusy(self, foundAddr, numNeededElements);
+            allocateElements(self, foundAddr, numNeededElements);
+            statsAllocated(self, size, numNeededElements, scanStart);
             Debug_LOG_TRACE("%s: size %zd, result is addr @%p, allocated %zd out of %zd elements",
                             __func__,
                             size,
@@ -357,6 +1001,78 @@ BitmapAllocator_alloc(Allocator* allocator, size_t size)
     return foundAddr;
 }
 
+void*
+BitmapAllocator_allocAligned(Allocator* allocator,
+                             size_t size,
+                             size_t alignment)
+{
+    BitmapAllocator* self = (BitmapAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+    Debug_ASSERT(alignment && !(alignment & (alignment - 1)));
+
+    void* foundAddr = NULL;
+    size_t stride = 1;
+    size_t candidate = getFirstAlignedElement(self, alignment, &stride);
+    size_t numNeededElements = TO_NUM_ELEMENTS(self, size);
+    size_t scanStart = statsScanStart(self);
+
+    if (!size
+        || numNeededElements > self->numElements - self->allocatedElements
+        || numNeededElements > self->maxFreeRun)
+    {
+        // do nothing
+    }
+    else
+    {
+        // only the aligned elements are tried, jumping from a busy element
+        // straight to the next aligned free one
+        while (candidate + numNeededElements <= self->numElements)
+        {
+            size_t numFree = countFreeElements(self,
+                                               candidate,
+                                               numNeededElements);
+            if (numFree >= numNeededElements)
+            {
+                foundAddr = TO_MEM_ADDR(self, candidate);
+                break;
+            }
+
+            size_t freeElementNum = findFreeElement(self,
+                                                    candidate + numFree);
+            if (NO_ELEMENT(self) == freeElementNum)
+            {
+                break;
+            }
+            candidate += ((freeElementNum - candidate + stride - 1) / stride)
+                         * stride;
+        }
+    }
+
+    if (NULL == foundAddr)
+    {
+        statsFailed(self, scanStart);
+        Debug_LOG_WARNING("%s: size %zd, alignment %zd, allocation failed, allocated %zd out of %zd elements",
+                          __func__,
+                          size,
+                          alignment,
+                          self->allocatedElements,
+                          self->numElements);
+    }
+    else
+    {
+        allocateElements(self, foundAddr, numNeededElements);
+        statsAllocated(self, size, numNeededElements, scanStart);
+        Debug_LOG_TRACE("%s: size %zd, alignment %zd, result is addr @%p, allocated %zd out of %zd elements",
+                        __func__,
+                        size,
+                        alignment,
+                        foundAddr,
+                        self->allocatedElements,
+                        self->numElements);
+    }
+    return foundAddr;
+}
+
 void
 BitmapAllocator_free(Allocator* allocator, void* ptr)
 {
@@ -373,18 +1089,277 @@ BitmapAllocator_free(Allocator* allocator, void* ptr)
     }
     else
     {
-        void* boundary      = findBoundaryOfAllocatedMemory(self, ptr);
-        size_t numElements  = getNumElements(self, ptr, boundary);
+        freeElements(self, ptr);
+        Debug_LOG_TRACE("%s: addr @%p, allocated %zd out of %zd elements",
+                        __func__,
+                        ptr,
+                        self->allocatedElements,
+                        self->numElements);
+    }
+}
 
-        markBitmapFree(self, ptr, numElements);
+size_t
+BitmapAllocator_allocBatch(Allocator* allocator,
+                           size_t size,
+                           void** ptrs,
+                           size_t num)
+{
+    BitmapAllocator* self = (BitmapAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+    Debug_ASSERT(NULL != ptrs || !num);
 
-        self->allocatedElements -= numElements;
-        Debug_LOG_TRACE("%s: addr @%p, allocated %zd out of %zd elements",
+    size_t count = 0;
+
+    if (!size)
+    {
+        // do nothing
+    }
+    else if (BitmapAllocator_Policy_NEXT_FIT == self->policy)
+    {
+        // the roving cursor already continues each search where the previous
+        // one stopped
+        size_t numNeededElements = TO_NUM_ELEMENTS(self, size);
+
+        for (; count < num; count++)
+        {
+            size_t scanStart = statsScanStart(self);
+
+            ptrs[count] = findContiguousFreeElements(self, numNeededElements);
+            if (NULL == ptrs[count])
+            {
+                statsFailed(self, scanStart);
+                break;
+            }
+            allocateElements(self, ptrs[count], numNeededElements);
+            statsAllocated(self, size, numNeededElements, scanStart);
+        }
+    }
+    else
+    {
+        // first-fit: no run of the requested size starts before the end of
+        // the previous one, so a single pass over the bitmap finds them all
+        size_t numNeededElements = TO_NUM_ELEMENTS(self, size);
+        size_t elementNum = 0;
+        size_t largestRun = 0;
+
+        for (; count < num; count++)
+        {
+            size_t scanStart = statsScanStart(self);
+
+            if (numNeededElements > self->numElements - self->allocatedElements
+                || numNeededElements > self->maxFreeRun)
+            {
+                statsFailed(self, scanStart);
+                break;
+            }
+            elementNum = findFreeRun(self,
+                                     elementNum,
+                                     NUM_SLOTS(self),
+                                     numNeededElements,
+                                     &largestRun);
+            if (NO_ELEMENT(self) == elementNum)
+            {
+                statsFailed(self, scanStart);
+                self->maxFreeRun = numNeededElements - 1;
+                break;
+            }
+            ptrs[count] = TO_MEM_ADDR(self, elementNum);
+            allocateElements(self, ptrs[count], numNeededElements);
+            statsAllocated(self, size, numNeededElements, scanStart);
+            elementNum += numNeededElements;
+        }
+    }
+    if (count < num)
+    {
+        Debug_LOG_WARNING("%s: size %zd, allocated %zd out of %zd requested, allocated %zd out of %zd elements",
+                          __func__,
+                          size,
+                          count,
+                          num,
+                          self->allocatedElements,
+                          self->numElements);
+    }
+    return count;
+}
+
+void
+BitmapAllocator_freeBatch(Allocator* allocator, void** ptrs, size_t num)
+{
+    BitmapAllocator* self = (BitmapAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+    Debug_ASSERT(NULL != ptrs || !num);
+
+    for (size_t i = 0; i < num; i++)
+    {
+        if (NULL == ptrs[i])
+        {
+            // do nothing
+        }
+        else if (!isAllocated(self, ptrs[i]))
+        {
+            Debug_LOG_WARNING("%s: ptr @%p was not allocated!",
+                              __func__, ptrs[i]);
+        }
+        else
+        {
+            freeElements(self, ptrs[i]);
+        }
+    }
+    Debug_LOG_TRACE("%s: freed %zd pointers, allocated %zd out of %zd elements",
+                    __func__,
+                    num,
+                    self->allocatedElements,
+                    self->numElements);
+}
+
+void*
+BitmapAllocator_realloc(Allocator* allocator, void* ptr, size_t size)
+{
+    BitmapAllocator* self = (BitmapAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    void* retval = NULL;
+
+    if (NULL == ptr)
+    {
+        retval = BitmapAllocator_alloc(allocator, size);
+    }
+    else if (!size)
+    {
+        BitmapAllocator_free(allocator, ptr);
+    }
+    else if (!isAllocated(self, ptr))
+    {
+        Debug_LOG_WARNING("%s: ptr @%p was not allocated!", __func__, ptr);
+    }
+    else
+    {
+        size_t numElements = getNumElements(
+                                 self,
+                                 ptr,
+                                 findBoundaryOfAllocatedMemory(self, ptr));
+        size_t numNeededElements = TO_NUM_ELEMENTS(self, size);
+
+        if (numNeededElements == numElements
+            || resizeInPlace(self, ptr, numElements, numNeededElements))
+        {
+            retval = ptr;
+        }
+        else
+        {
+            retval = BitmapAllocator_alloc(allocator, size);
+            if (retval != NULL)
+            {
+                // we only get here when growing
+                memcpy(retval, ptr, numElements * self->elementSize);
+                freeElements(self, ptr);
+            }
+        }
+        Debug_LOG_TRACE("%s: addr @%p, size %zd, result is addr @%p, allocated %zd out of %zd elements",
                         __func__,
                         ptr,
+                        size,
+                        retval,
                         self->allocatedElements,
                         self->numElements);
     }
+    return retval;
+}
+
+size_t
+BitmapAllocator_usableSize(Allocator* allocator, void* ptr)
+{
+    BitmapAllocator* self = (BitmapAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    size_t retval = 0;
+
+    if (!isAllocated(self, ptr))
+    {
+        retval = 0;
+    }
+    else
+    {
+        retval = getNumElements(self,
+                                ptr,
+                                findBoundaryOfAllocatedMemory(self, ptr))
+                 * self->elementSize;
+    }
+    return retval;
+}
+
+void
+BitmapAllocator_getFragmentation(BitmapAllocator* self,
+                                 BitmapAllocator_Fragmentation* report)
+{
+    Debug_ASSERT_SELF(self);
+    Debug_ASSERT(NULL != report);
+
+    const size_t bitsInSlot = BITS_IN_A_BITMAP_SLOT(self);
+    size_t amount = 0;
+
+    memset(report, 0, sizeof(*report));
+
+    for (size_t slot = 0; slot < NUM_SLOTS(self); slot++)
+    {
+        BitmapAllocator_BitmapSlot busy = getBusyBits(self, slot);
+
+        report->liveAllocations += countOnes(self->boundaryBitmap[slot]);
+
+        if (SLOT_FULL == busy)
+        {
+            addFreeRun(report, amount);
+            amount = 0;
+        }
+        else if (0 == busy)
+        {
+            amount += bitsInSlot;
+        }
+        else
+        {
+            size_t offset = 0;
+
+            while (offset < bitsInSlot)
+            {
+                BitmapAllocator_BitmapSlot rest = busy >> offset;
+                size_t freeRun = rest ? countTrailingZeros(rest)
+                                 : bitsInSlot - offset;
+                amount += freeRun;
+                offset += freeRun;
+                if (offset < bitsInSlot)
+                {
+                    addFreeRun(report, amount);
+                    offset += countTrailingZeros(~(busy >> offset));
+                    amount = 0;
+                }
+            }
+        }
+    }
+    addFreeRun(report, amount);
+
+    report->fragmentation = report->freeElements
+                            ? 1000 - (unsigned) (1000 * report->largestFreeRun
+                                                 / report->freeElements)
+                            : 0;
+
+    // the walk measured the longest run exactly
+    self->maxFreeRun = report->largestFreeRun;
+}
+
+bool
+BitmapAllocator_getStats(const BitmapAllocator* self,
+                         BitmapAllocator_Stats* stats)
+{
+    Debug_ASSERT_SELF(self);
+    Debug_ASSERT(NULL != stats);
+
+#if defined(Memory_Config_BITMAP_ALLOCATOR_STATS)
+    *stats = self->stats;
+    return true;
+#else
+    (void) stats;
+    return false;
+#endif
 }
 
 #if !defined(Memory_Config_STATIC)
@@ -399,6 +1374,7 @@ BitmapAllocator_dtor(Allocator* stream)
         Memory_free(self->baseAddr);
         Memory_free((void*) self->bitmap);
         Memory_free((void*) self->boundaryBitmap);
+        Memory_free((void*) self->summaryBitmap);
     }
 }
 #endif
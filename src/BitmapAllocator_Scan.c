@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "BitmapAllocator_Scan.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#   define BITMAP_SCAN_X86_64
+#   include <immintrin.h>
+#endif
+
+/* Defines -------------------------------------------------------------------*/
+
+#define SLOT_FULL ((BitmapAllocator_BitmapSlot) ~((BitmapAllocator_BitmapSlot) 0))
+#define SLOTS_IN(bytes) ((bytes) / sizeof(BitmapAllocator_BitmapSlot))
+
+/* Private functions prototypes ----------------------------------------------*/
+
+static size_t
+skipFullSlotsScalar(const BitmapAllocator_BitmapSlot* bitmap,
+                    size_t slot,
+                    size_t endSlot);
+
+#if defined(BITMAP_SCAN_X86_64)
+static size_t
+skipFullSlotsSse2(const BitmapAllocator_BitmapSlot* bitmap,
+                  size_t slot,
+                  size_t endSlot);
+
+static size_t
+skipFullSlotsAvx2(const BitmapAllocator_BitmapSlot* bitmap,
+                  size_t slot,
+                  size_t endSlot);
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+/* Public functions ----------------------------------------------------------*/
+
+BitmapAllocator_SkipFullT
+BitmapAllocator_Scan_getKernel(BitmapAllocator_Kernel kernel)
+{
+    BitmapAllocator_SkipFullT retval = NULL;
+
+#if defined(BITMAP_SCAN_X86_64)
+    __builtin_cpu_init();
+    bool hasAvx2 = __builtin_cpu_supports("avx2");
+#endif
+
+    switch (kernel)
+    {
+    case BitmapAllocator_Kernel_AUTO:
+#if defined(BITMAP_SCAN_X86_64)
+        // SSE2 is part of the x86-64 baseline
+        retval = hasAvx2 ? skipFullSlotsAvx2 : skipFullSlotsSse2;
+#else
+        retval = skipFullSlotsScalar;
+#endif
+        break;
+    case BitmapAllocator_Kernel_SCALAR:
+        retval = skipFullSlotsScalar;
+        break;
+#if defined(BITMAP_SCAN_X86_64)
+    case BitmapAllocator_Kernel_SSE2:
+        retval = skipFullSlotsSse2;
+        break;
+    case BitmapAllocator_Kernel_AVX2:
+        retval = hasAvx2 ? skipFullSlotsAvx2 : NULL;
+        break;
+#endif
+    default:
+        retval = NULL;
+        break;
+    }
+    return retval;
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+
+static size_t
+skipFullSlotsScalar(const BitmapAllocator_BitmapSlot* bitmap,
+                    size_t slot,
+                    size_t endSlot)
+{
+    while (slot < endSlot && SLOT_FULL == bitmap[slot])
+    {
+        slot++;
+    }
+    return slot;
+}
+
+#if defined(BITMAP_SCAN_X86_64)
+static size_t
+skipFullSlotsSse2(const BitmapAllocator_BitmapSlot* bitmap,
+                  size_t slot,
+                  size_t endSlot)
+{
+    const __m128i full = _mm_set1_epi8(-1);
+
+    // the bitmap is not necessarily aligned to the vector size
+    while (slot + SLOTS_IN(sizeof(__m128i)) <= endSlot)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*) &bitmap[slot]);
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, full)) != 0xFFFF)
+        {
+            break;
+        }
+        slot += SLOTS_IN(sizeof(__m128i));
+    }
+    return skipFullSlotsScalar(bitmap, slot, endSlot);
+}
+
+__attribute__((target("avx2")))
+static size_t
+skipFullSlotsAvx2(const BitmapAllocator_BitmapSlot* bitmap,
+                  size_t slot,
+                  size_t endSlot)
+{
+    const __m256i full = _mm256_set1_epi8(-1);
+
+    while (slot + SLOTS_IN(sizeof(__m256i)) <= endSlot)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*) &bitmap[slot]);
+
+        // sets the carry flag if all the bits of full are set in v
+        if (!_mm256_testc_si256(v, full))
+        {
+            break;
+        }
+        slot += SLOTS_IN(sizeof(__m256i));
+    }
+    return skipFullSlotsScalar(bitmap, slot, endSlot);
+}
+#endif
+
+
+///@}
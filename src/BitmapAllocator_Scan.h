@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+*/
+
+/**
+ * @addtogroup lib_mem
+ * @{
+ *
+ * @file BitmapAllocator_Scan.h
+ *
+ * @brief kernels skipping the fully busy slots of a BitmapAllocator bitmap
+ */
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/BitmapAllocator.h"
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported types ------------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+/* Exported dynamic functions ----------------------------------------------- */
+/* Exported static functions -------------------------------------------------*/
+
+/**
+ * @brief returns the kernel implementing the requested variant
+ *
+ * @param kernel the variant, BitmapAllocator_Kernel_AUTO picks the fastest
+ *  one supported by the CPU we are running on
+ *
+ * @return the kernel or NULL if the variant is not supported
+ */
+BitmapAllocator_SkipFullT
+BitmapAllocator_Scan_getKernel(BitmapAllocator_Kernel kernel);
+
+///@}
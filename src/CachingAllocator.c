@@ -0,0 +1,300 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "lib_mem/CachingAllocator.h"
+
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+
+// the header keeps the blocks aligned like the ones of the backing allocator
+#define HEADER_SIZE _Alignof(max_align_t)
+
+/* Private types -------------------------------------------------------------*/
+
+typedef struct
+{
+    size_t  count;
+    void**  blocks;
+}
+Magazine;
+
+typedef struct ThreadCache ThreadCache;
+
+// the magazines of a thread for one CachingAllocator, allocated from its
+// backing allocator together with the block pointers
+struct ThreadCache
+{
+    CachingAllocator*   owner;
+    ThreadCache*        next;
+    Magazine*           magazines;
+};
+
+/* Private functions prototypes ----------------------------------------------*/
+
+static ThreadCache*
+getThreadCache(CachingAllocator* self, bool create);
+
+/* Private variables ---------------------------------------------------------*/
+
+static _Thread_local ThreadCache* threadCaches;
+
+static const Allocator_Vtable CachingAllocator_vtable =
+{
+    .alloc        = CachingAllocator_alloc,
+    .free         = CachingAllocator_free,
+    .dtor         = CachingAllocator_dtor,
+    .usableSize   = CachingAllocator_usableSize
+};
+
+/* Public functions ----------------------------------------------------------*/
+bool
+CachingAllocator_ctor(CachingAllocator* self,
+                      Allocator* backing,
+                      const size_t* classSizes,
+                      size_t numClasses,
+                      size_t magazineSize)
+{
+    Debug_ASSERT_SELF(self);
+
+    bool retval = true;
+
+    if (NULL == backing
+        || NULL == classSizes
+        || !numClasses
+        || magazineSize < 2
+        || !classSizes[0])
+    {
+        retval = false;
+    }
+    for (size_t i = 1; retval && i < numClasses; i++)
+    {
+        retval = classSizes[i] > classSizes[i - 1];
+    }
+    if (retval)
+    {
+        self->backing       = backing;
+        self->classSizes    = classSizes;
+        self->numClasses    = numClasses;
+        self->magazineSize  = magazineSize;
+        self->parent.vtable = &CachingAllocator_vtable;
+    }
+    return retval;
+}
+
+void*
+CachingAllocator_alloc(Allocator* allocator, size_t size)
+{
+    CachingAllocator* self = (CachingAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    void* retval = NULL;
+    size_t sizeClass = 0;
+    uint8_t* block = NULL;
+
+    while (sizeClass < self->numClasses && size > self->classSizes[sizeClass])
+    {
+        sizeClass++;
+    }
+
+    if (!size || size > SIZE_MAX - HEADER_SIZE)
+    {
+        // do nothing, adding the header would wrap around
+    }
+    else if (sizeClass == self->numClasses)
+    {
+        block = Allocator_alloc(self->backing, HEADER_SIZE + size);
+    }
+    else
+    {
+        size_t blockSize = HEADER_SIZE + self->classSizes[sizeClass];
+        ThreadCache* cache = getThreadCache(self, true);
+
+        if (NULL == cache)
+        {
+            block = Allocator_alloc(self->backing, blockSize);
+        }
+        else
+        {
+            Magazine* magazine = &cache->magazines[sizeClass];
+
+            if (!magazine->count)
+            {
+                magazine->count = Allocator_allocBatch(self->backing,
+                                                       blockSize,
+                                                       magazine->blocks,
+                                                       self->magazineSize / 2);
+            }
+            block = magazine->count ? magazine->blocks[--magazine->count]
+                    : NULL;
+        }
+    }
+
+    if (block != NULL)
+    {
+        *(size_t*) block = sizeClass;
+        retval = block + HEADER_SIZE;
+    }
+    return retval;
+}
+
+void
+CachingAllocator_free(Allocator* allocator, void* ptr)
+{
+    CachingAllocator* self = (CachingAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    if (NULL == ptr)
+    {
+        // do nothing
+    }
+    else
+    {
+        uint8_t* block = (uint8_t*) ptr - HEADER_SIZE;
+        size_t sizeClass = *(size_t*) block;
+        ThreadCache* cache = (sizeClass < self->numClasses)
+                             ? getThreadCache(self, true)
+                             : NULL;
+
+        if (NULL == cache)
+        {
+            Allocator_free(self->backing, block);
+        }
+        else
+        {
+            Magazine* magazine = &cache->magazines[sizeClass];
+
+            if (magazine->count == self->magazineSize)
+            {
+                // the oldest blocks go back, the recent ones are still hot
+                size_t half = self->magazineSize / 2;
+
+                Allocator_freeBatch(self->backing, magazine->blocks, half);
+                memmove(magazine->blocks,
+                        &magazine->blocks[half],
+                        (magazine->count - half) * sizeof(void*));
+                magazine->count -= half;
+            }
+            magazine->blocks[magazine->count++] = block;
+        }
+    }
+}
+
+size_t
+CachingAllocator_usableSize(Allocator* allocator, void* ptr)
+{
+    CachingAllocator* self = (CachingAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    size_t retval = 0;
+
+    if (NULL == ptr)
+    {
+        retval = 0;
+    }
+    else
+    {
+        uint8_t* block = (uint8_t*) ptr - HEADER_SIZE;
+        size_t sizeClass = *(size_t*) block;
+
+        if (sizeClass < self->numClasses)
+        {
+            retval = self->classSizes[sizeClass];
+        }
+        else
+        {
+            retval = Allocator_usableSize(self->backing, block);
+            retval = retval ? retval - HEADER_SIZE : 0;
+        }
+    }
+    return retval;
+}
+
+void
+CachingAllocator_flushThread(CachingAllocator* self)
+{
+    Debug_ASSERT_SELF(self);
+
+    ThreadCache* cache = getThreadCache(self, false);
+
+    if (cache != NULL)
+    {
+        for (size_t i = 0; i < self->numClasses; i++)
+        {
+            Allocator_freeBatch(self->backing,
+                                cache->magazines[i].blocks,
+                                cache->magazines[i].count);
+        }
+        // getThreadCache() has moved it to the front
+        threadCaches = cache->next;
+        Allocator_free(self->backing, cache);
+    }
+}
+
+void
+CachingAllocator_dtor(Allocator* allocator)
+{
+    CachingAllocator* self = (CachingAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    CachingAllocator_flushThread(self);
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+
+// returns the cache of the calling thread for self moved to the front of its
+// list, creates it if asked to, NULL if there is none
+static ThreadCache*
+getThreadCache(CachingAllocator* self, bool create)
+{
+    ThreadCache** link = &threadCaches;
+
+    while (*link != NULL && (*link)->owner != self)
+    {
+        link = &(*link)->next;
+    }
+
+    ThreadCache* cache = *link;
+
+    if (cache != NULL)
+    {
+        *link = cache->next;
+    }
+    else if (create)
+    {
+        cache = Allocator_alloc(self->backing,
+                                sizeof(ThreadCache)
+                                + self->numClasses * sizeof(Magazine)
+                                + self->numClasses * self->magazineSize
+                                * sizeof(void*));
+        if (cache != NULL)
+        {
+            void** blocks;
+
+            cache->owner     = self;
+            cache->magazines = (Magazine*) (cache + 1);
+            blocks           = (void**) (cache->magazines + self->numClasses);
+            for (size_t i = 0; i < self->numClasses; i++)
+            {
+                cache->magazines[i].count  = 0;
+                cache->magazines[i].blocks = &blocks[i * self->magazineSize];
+            }
+        }
+    }
+    if (cache != NULL)
+    {
+        cache->next  = threadCaches;
+        threadCaches = cache;
+    }
+    return cache;
+}
+
+
+///@}
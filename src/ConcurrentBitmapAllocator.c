@@ -0,0 +1,514 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/ConcurrentBitmapAllocator.h"
+#include "lib_debug/Debug.h"
+#include "lib_mem/Memory.h"
+
+#include <stdbool.h>
+
+
+/* Defines -------------------------------------------------------------------*/
+
+#define BITS_IN_A_BITMAP_SLOT   BitmapAllocator_BITS_IN_A_SLOT
+#define SLOT(elementNum)        ((elementNum) / BITS_IN_A_BITMAP_SLOT)
+#define OFFSET(elementNum)      ((elementNum) % BITS_IN_A_BITMAP_SLOT)
+#define NUM_SLOTS(self)         (SLOT((self)->numElements - 1) + 1)
+#define NO_ELEMENT(self)        ((self)->numElements)
+#define SLOT_FULL ((BitmapAllocator_BitmapSlot) ~((BitmapAllocator_BitmapSlot) 0))
+#define ELEMENT_NUM(slot, offset)\
+    ((slot) * BITS_IN_A_BITMAP_SLOT + (offset))
+// precondition is that ptr is within our boundaries
+#define TO_ELEMENT_NUM(self, ptr)\
+    (((ptr) - (self)->baseAddr) / (self)->elementSize)
+#define TO_NUM_ELEMENTS(self, size)\
+    ((size) / (self)->elementSize + (((size) % (self)->elementSize) ? 1 : 0))
+#define TO_MEM_ADDR(self, elNum)\
+    (((self)->baseAddr) + (elNum) * (self)->elementSize)
+
+#define LOAD(word)          __atomic_load_n(&(word), __ATOMIC_ACQUIRE)
+#define FETCH_OR(word, v)   __atomic_fetch_or(&(word), (v), __ATOMIC_ACQ_REL)
+#define FETCH_AND(word, v)  __atomic_fetch_and(&(word), (v), __ATOMIC_ACQ_REL)
+#define CAS(word, expected, desired)\
+    __atomic_compare_exchange_n(&(word), &(expected), (desired), true,\
+                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+
+/* Private functions prototypes ----------------------------------------------*/
+
+INLINE bool
+isInRange(ConcurrentBitmapAllocator* self, void* ptr)
+{
+    return (ptr != NULL
+            && ptr >= self->baseAddr
+            && ptr < self->baseAddr + self->numElements * self->elementSize);
+}
+
+INLINE bool
+isAllocated(ConcurrentBitmapAllocator* self, void* ptr)
+{
+    bool retval = false;
+
+    if (!isInRange(self, ptr))
+    {
+        retval = false;
+    }
+    else
+    {
+        size_t elementNum = TO_ELEMENT_NUM(self, ptr);
+
+        retval = Bitmap_GET_BIT(LOAD(self->bitmap[SLOT(elementNum)]),
+                                OFFSET(elementNum));
+    }
+    return retval;
+}
+
+INLINE size_t
+countTrailingZeros(BitmapAllocator_BitmapSlot word)
+{
+    Debug_ASSERT(word != 0);
+
+    return (sizeof(word) <= sizeof(unsigned int)) ? __builtin_ctz(word)
+           : (sizeof(word) <= sizeof(unsigned long)) ? __builtin_ctzl(word)
+           : __builtin_ctzll(word);
+}
+
+// the bits past the last element of the pool are reported as busy
+INLINE BitmapAllocator_BitmapSlot
+getTailBits(ConcurrentBitmapAllocator* self, size_t slot)
+{
+    return (SLOT(self->numElements) == slot)
+           ? (BitmapAllocator_BitmapSlot) (SLOT_FULL
+                                           << OFFSET(self->numElements))
+           : 0;
+}
+
+// returns a mask of 'count' bits starting at bit 'offset' of a slot
+INLINE BitmapAllocator_BitmapSlot
+getRangeMask(size_t offset, size_t count)
+{
+    Debug_ASSERT(offset + count <= BITS_IN_A_BITMAP_SLOT);
+
+    return ((count < BITS_IN_A_BITMAP_SLOT)
+            ? (((BitmapAllocator_BitmapSlot) 1 << count) - 1)
+            : SLOT_FULL) << offset;
+}
+
+// claims a free bit with a compare-and-swap, starting at the hint slot and
+// wrapping around, returns NO_ELEMENT(self) if all the elements are busy
+INLINE size_t
+claimElement(ConcurrentBitmapAllocator* self)
+{
+    size_t numSlots = NUM_SLOTS(self);
+    size_t slot = __atomic_load_n(&self->hint, __ATOMIC_RELAXED);
+
+    for (size_t i = 0; i < numSlots; i++)
+    {
+        BitmapAllocator_BitmapSlot word = LOAD(self->bitmap[slot]);
+
+        while ((BitmapAllocator_BitmapSlot) (word | getTailBits(self, slot))
+               != SLOT_FULL)
+        {
+            size_t offset = countTrailingZeros(
+                                (BitmapAllocator_BitmapSlot)
+                                ~(word | getTailBits(self, slot)));
+            BitmapAllocator_BitmapSlot claimed =
+                word | ((BitmapAllocator_BitmapSlot) 1 << offset);
+
+            // on failure word receives the current value
+            if (CAS(self->bitmap[slot], word, claimed))
+            {
+                if (i)
+                {
+                    __atomic_store_n(&self->hint, slot, __ATOMIC_RELAXED);
+                }
+                return ELEMENT_NUM(slot, offset);
+            }
+        }
+        slot = (slot + 1 < numSlots) ? slot + 1 : 0;
+    }
+    return NO_ELEMENT(self);
+}
+
+// looks for numElements free elements from firstElement on, the result may
+// be stale by the time it is claimed
+INLINE size_t
+findFreeRun(ConcurrentBitmapAllocator* self,
+            size_t firstElement,
+            size_t numElements)
+{
+    size_t amount = 0;
+    size_t needle = 0;
+
+    for (size_t slot = SLOT(firstElement); slot < NUM_SLOTS(self); slot++)
+    {
+        BitmapAllocator_BitmapSlot busy =
+            LOAD(self->bitmap[slot]) | getTailBits(self, slot);
+
+        if (SLOT(firstElement) == slot)
+        {
+            busy |= ~(SLOT_FULL << OFFSET(firstElement));
+        }
+
+        size_t offset = 0;
+
+        while (offset < BITS_IN_A_BITMAP_SLOT)
+        {
+            BitmapAllocator_BitmapSlot rest = busy >> offset;
+            size_t freeRun = rest ? countTrailingZeros(rest)
+                             : BITS_IN_A_BITMAP_SLOT - offset;
+            if (freeRun)
+            {
+                needle = amount ? needle : ELEMENT_NUM(slot, offset);
+                amount += freeRun;
+                if (amount >= numElements)
+                {
+                    return needle;
+                }
+                offset += freeRun;
+            }
+            if (offset < BITS_IN_A_BITMAP_SLOT)
+            {
+                BitmapAllocator_BitmapSlot freeBits =
+                    (BitmapAllocator_BitmapSlot) ~(busy >> offset);
+                offset += freeBits ? countTrailingZeros(freeBits)
+                          : BITS_IN_A_BITMAP_SLOT - offset;
+                amount = 0;
+            }
+        }
+    }
+    return NO_ELEMENT(self);
+}
+
+// clears the bits of the elements [elementNum, elementNum + numElements)
+INLINE void
+releaseRange(ConcurrentBitmapAllocator* self,
+             size_t elementNum,
+             size_t numElements)
+{
+    size_t slot = SLOT(elementNum);
+    size_t offset = OFFSET(elementNum);
+
+    while (numElements)
+    {
+        size_t count = BITS_IN_A_BITMAP_SLOT - offset;
+        count = (numElements < count) ? numElements : count;
+
+        FETCH_AND(self->bitmap[slot],
+                  (BitmapAllocator_BitmapSlot) ~getRangeMask(offset, count));
+
+        numElements -= count;
+        offset       = 0;
+        slot++;
+    }
+}
+
+// sets the bits of the elements [elementNum, elementNum + numElements) one
+// slot at a time, gives back the slots already claimed and returns false if
+// one of the elements was taken in the meantime
+INLINE bool
+claimRange(ConcurrentBitmapAllocator* self,
+           size_t elementNum,
+           size_t numElements)
+{
+    size_t slot = SLOT(elementNum);
+    size_t offset = OFFSET(elementNum);
+    size_t remaining = numElements;
+
+    while (remaining)
+    {
+        size_t count = BITS_IN_A_BITMAP_SLOT - offset;
+        count = (remaining < count) ? remaining : count;
+
+        BitmapAllocator_BitmapSlot mask = getRangeMask(offset, count);
+        BitmapAllocator_BitmapSlot word = LOAD(self->bitmap[slot]);
+
+        do
+        {
+            if (word & mask)
+            {
+                releaseRange(self, elementNum, numElements - remaining);
+                return false;
+            }
+        }
+        while (!CAS(self->bitmap[slot], word, word | mask));
+
+        remaining -= count;
+        offset     = 0;
+        slot++;
+    }
+    return true;
+}
+
+INLINE size_t
+allocateRange(ConcurrentBitmapAllocator* self, size_t numElements)
+{
+    size_t elementNum = NO_ELEMENT(self);
+    size_t firstElement = 0;
+
+    Mutex_acquire(self->mutex);
+
+    for (;;)
+    {
+        elementNum = findFreeRun(self, firstElement, numElements);
+        if (NO_ELEMENT(self) == elementNum
+            || claimRange(self, elementNum, numElements))
+        {
+            break;
+        }
+        // a single element was claimed inside the run, look further on
+        firstElement = elementNum + 1;
+    }
+
+    Mutex_release(self->mutex);
+
+    return elementNum;
+}
+
+// precondition is that ptr is the start of an allocation
+INLINE size_t
+findBoundary(ConcurrentBitmapAllocator* self, size_t elementNum)
+{
+    size_t slot = SLOT(elementNum);
+    BitmapAllocator_BitmapSlot boundaries =
+        LOAD(self->boundaryBitmap[slot]) & (SLOT_FULL << OFFSET(elementNum));
+
+    while (!boundaries)
+    {
+        // every allocation has a boundary, so we can not run past the end
+        Debug_ASSERT(slot + 1 < NUM_SLOTS(self));
+        boundaries = LOAD(self->boundaryBitmap[++slot]);
+    }
+    return ELEMENT_NUM(slot, countTrailingZeros(boundaries));
+}
+
+
+/* Private variables ---------------------------------------------------------*/
+
+static const Allocator_Vtable ConcurrentBitmapAllocator_vtable =
+{
+    .alloc        = ConcurrentBitmapAllocator_alloc,
+    .free         = ConcurrentBitmapAllocator_free,
+    .dtor         = ConcurrentBitmapAllocator_dtor,
+    .usableSize   = ConcurrentBitmapAllocator_usableSize
+};
+
+
+/* Public functions ----------------------------------------------------------*/
+
+#if !defined(Memory_Config_STATIC)
+bool
+ConcurrentBitmapAllocator_ctor(ConcurrentBitmapAllocator* self,
+                               size_t elementSize,
+                               size_t numElements,
+                               Mutex* mutex)
+{
+    Debug_ASSERT_SELF(self);
+
+    bool retval = false;
+    size_t bitmapSize = BitmapAllocator_BITMAP_SIZE(numElements);
+
+    void* buffer           = Memory_alloc(numElements * elementSize);
+    void* bitmap           = Memory_calloc(1, bitmapSize);
+    void* boundaryBitmap   = Memory_calloc(1, bitmapSize);
+
+    if (NULL == buffer || NULL == bitmap || NULL == boundaryBitmap)
+    {
+        retval = false;
+    }
+    else
+    {
+        retval = ConcurrentBitmapAllocator_ctorStatic(self,
+                                                      buffer,
+                                                      bitmap,
+                                                      boundaryBitmap,
+                                                      elementSize,
+                                                      numElements,
+                                                      mutex);
+        self->isStatic = false;
+    }
+    if (!retval)
+    {
+        Memory_free(buffer);
+        Memory_free(bitmap);
+        Memory_free(boundaryBitmap);
+    }
+    return retval;
+}
+#endif
+
+bool
+ConcurrentBitmapAllocator_ctorStatic(ConcurrentBitmapAllocator* self,
+                                     void* buffer,
+                                     void* bitmap,
+                                     void* boundaryBitmap,
+                                     size_t elementSize,
+                                     size_t numElements,
+                                     Mutex* mutex)
+{
+    Debug_ASSERT_SELF(self);
+
+    Debug_LOG_TRACE("%s: buffer @%p, elementSize %zd, numElements %zd",
+                    __func__, buffer, elementSize, numElements);
+
+    bool retval = false;
+
+    if (!numElements
+        || !elementSize
+        || NULL == buffer
+        || NULL == bitmap
+        || NULL == boundaryBitmap
+        || NULL == mutex)
+    {
+        retval = false;
+    }
+    else
+    {
+        memset(self, 0, sizeof(*self));
+
+        self->baseAddr          = buffer;
+        self->bitmap            = bitmap;
+        self->boundaryBitmap    = boundaryBitmap;
+        self->elementSize       = elementSize;
+        self->numElements       = numElements;
+        self->mutex             = mutex;
+        self->isStatic          = true;
+
+        self->parent.vtable = &ConcurrentBitmapAllocator_vtable;
+
+        retval = true;
+    }
+    return retval;
+}
+
+void*
+ConcurrentBitmapAllocator_alloc(Allocator* allocator, size_t size)
+{
+    ConcurrentBitmapAllocator* self = (ConcurrentBitmapAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    void* foundAddr = NULL;
+    size_t numNeededElements = TO_NUM_ELEMENTS(self, size);
+    size_t elementNum = NO_ELEMENT(self);
+
+    if (!size || numNeededElements > self->numElements)
+    {
+        // do nothing
+    }
+    else
+    {
+        elementNum = (1 == numNeededElements)
+                     ? claimElement(self)
+                     : allocateRange(self, numNeededElements);
+    }
+
+    if (NO_ELEMENT(self) == elementNum)
+    {
+        Debug_LOG_WARNING("%s: size %zd, allocation failed, allocated %zd out of %zd elements",
+                          __func__,
+                          size,
+                          __atomic_load_n(&self->allocatedElements,
+                                          __ATOMIC_RELAXED),
+                          self->numElements);
+    }
+    else
+    {
+        size_t last = elementNum + numNeededElements - 1;
+
+        // the elements are ours, now the free can find their end
+        FETCH_OR(self->boundaryBitmap[SLOT(last)],
+                 (BitmapAllocator_BitmapSlot) 1 << OFFSET(last));
+        __atomic_fetch_add(&self->allocatedElements,
+                           numNeededElements,
+                           __ATOMIC_RELAXED);
+
+        foundAddr = TO_MEM_ADDR(self, elementNum);
+        Debug_LOG_TRACE("%s: size %zd, result is addr @%p",
+                        __func__,
+                        size,
+                        foundAddr);
+    }
+    return foundAddr;
+}
+
+void
+ConcurrentBitmapAllocator_free(Allocator* allocator, void* ptr)
+{
+    ConcurrentBitmapAllocator* self = (ConcurrentBitmapAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    if (NULL == ptr)
+    {
+        // do nothing
+    }
+    else if (!isAllocated(self, ptr))
+    {
+        Debug_LOG_WARNING("%s: ptr @%p was not allocated!", __func__, ptr);
+    }
+    else
+    {
+        size_t elementNum = TO_ELEMENT_NUM(self, ptr);
+        size_t last = findBoundary(self, elementNum);
+
+        // the boundary goes first, so that the elements are never free while
+        // still marked as the end of an allocation
+        FETCH_AND(self->boundaryBitmap[SLOT(last)],
+                  (BitmapAllocator_BitmapSlot)
+                  ~((BitmapAllocator_BitmapSlot) 1 << OFFSET(last)));
+        releaseRange(self, elementNum, last - elementNum + 1);
+        __atomic_fetch_sub(&self->allocatedElements,
+                           last - elementNum + 1,
+                           __ATOMIC_RELAXED);
+
+        Debug_LOG_TRACE("%s: addr @%p", __func__, ptr);
+    }
+}
+
+size_t
+ConcurrentBitmapAllocator_usableSize(Allocator* allocator, void* ptr)
+{
+    ConcurrentBitmapAllocator* self = (ConcurrentBitmapAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    size_t retval = 0;
+
+    if (!isAllocated(self, ptr))
+    {
+        retval = 0;
+    }
+    else
+    {
+        size_t elementNum = TO_ELEMENT_NUM(self, ptr);
+
+        retval = (findBoundary(self, elementNum) - elementNum + 1)
+                 * self->elementSize;
+    }
+    return retval;
+}
+
+void
+ConcurrentBitmapAllocator_dtor(Allocator* allocator)
+{
+    ConcurrentBitmapAllocator* self = (ConcurrentBitmapAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+#if !defined(Memory_Config_STATIC)
+    if (!self->isStatic)
+    {
+        Memory_free(self->baseAddr);
+        Memory_free((void*) self->bitmap);
+        Memory_free((void*) self->boundaryBitmap);
+    }
+#endif
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+
+///@}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/DeferredFreeAllocator.h"
+#include "lib_debug/Debug.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+
+/* Defines -------------------------------------------------------------------*/
+
+// the address of a thread local variable is unique among the living threads
+#define THIS_THREAD ((const void*) &threadToken)
+
+/* Private functions prototypes ----------------------------------------------*/
+
+// the blocks need not be aligned for a pointer, the links are copied
+INLINE void*
+getNext(void* block)
+{
+    void* next;
+
+    memcpy(&next, block, sizeof(next));
+    return next;
+}
+
+INLINE void
+setNext(void* block, void* next)
+{
+    memcpy(block, &next, sizeof(next));
+}
+
+/* Private variables ---------------------------------------------------------*/
+
+static _Thread_local char threadToken;
+
+static const Allocator_Vtable DeferredFreeAllocator_vtable =
+{
+    .alloc        = DeferredFreeAllocator_alloc,
+    .free         = DeferredFreeAllocator_free,
+    .dtor         = DeferredFreeAllocator_dtor,
+    .usableSize   = DeferredFreeAllocator_usableSize
+};
+
+
+/* Public functions ----------------------------------------------------------*/
+bool
+DeferredFreeAllocator_ctor(DeferredFreeAllocator* self,
+                           Allocator* impl)
+{
+    Debug_ASSERT_SELF(self);
+
+    bool retval = true;
+
+    if (NULL == impl)
+    {
+        retval = false;
+    }
+    else
+    {
+        self->impl    = impl;
+        self->owner   = THIS_THREAD;
+        self->pending = NULL;
+        self->parent.vtable = &DeferredFreeAllocator_vtable;
+    }
+    return retval;
+}
+
+void
+DeferredFreeAllocator_setOwner(DeferredFreeAllocator* self)
+{
+    Debug_ASSERT_SELF(self);
+
+    __atomic_store_n(&self->owner, THIS_THREAD, __ATOMIC_RELEASE);
+}
+
+void*
+DeferredFreeAllocator_alloc(Allocator* allocator, size_t size)
+{
+    DeferredFreeAllocator* self = (DeferredFreeAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+    Debug_ASSERT(self->owner == THIS_THREAD);
+
+    if (__atomic_load_n(&self->pending, __ATOMIC_RELAXED) != NULL)
+    {
+        DeferredFreeAllocator_drain(self);
+    }
+    // any block may have to hold a link later on
+    return Allocator_alloc(self->impl,
+                           (size && size < DeferredFreeAllocator_MIN_BLOCK_SIZE)
+                           ? DeferredFreeAllocator_MIN_BLOCK_SIZE
+                           : size);
+}
+
+void
+DeferredFreeAllocator_free(Allocator* allocator, void* ptr)
+{
+    DeferredFreeAllocator* self = (DeferredFreeAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    if (NULL == ptr)
+    {
+        // do nothing
+    }
+    else if (__atomic_load_n(&self->owner, __ATOMIC_ACQUIRE) == THIS_THREAD)
+    {
+        Allocator_free(self->impl, ptr);
+    }
+    else
+    {
+        void* head = __atomic_load_n(&self->pending, __ATOMIC_RELAXED);
+
+        // on failure head receives the current value
+        do
+        {
+            setNext(ptr, head);
+        }
+        while (!__atomic_compare_exchange_n(&self->pending,
+                                            &head,
+                                            ptr,
+                                            true,
+                                            __ATOMIC_RELEASE,
+                                            __ATOMIC_RELAXED));
+    }
+}
+
+size_t
+DeferredFreeAllocator_usableSize(Allocator* allocator, void* ptr)
+{
+    DeferredFreeAllocator* self = (DeferredFreeAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+    Debug_ASSERT(self->owner == THIS_THREAD);
+
+    return Allocator_usableSize(self->impl, ptr);
+}
+
+size_t
+DeferredFreeAllocator_drain(DeferredFreeAllocator* self)
+{
+    Debug_ASSERT_SELF(self);
+    Debug_ASSERT(self->owner == THIS_THREAD);
+
+    size_t retval = 0;
+    // the whole list is taken at once, the pushes go to a new one
+    void* block = __atomic_exchange_n(&self->pending, NULL, __ATOMIC_ACQUIRE);
+
+    while (block != NULL)
+    {
+        void* next = getNext(block);
+
+        Allocator_free(self->impl, block);
+        block = next;
+        retval++;
+    }
+    return retval;
+}
+
+void
+DeferredFreeAllocator_dtor(Allocator* allocator)
+{
+    DeferredFreeAllocator* self = (DeferredFreeAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    DeferredFreeAllocator_drain(self);
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+
+
+///@}
@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/RingAllocator.h"
+#include "lib_debug/Debug.h"
+#include "lib_mem/Memory.h"
+
+#include <stdbool.h>
+
+
+/* Private types -------------------------------------------------------------*/
+
+typedef struct
+{
+    size_t  seq;
+    size_t  size;
+}
+Header;
+
+/* Defines -------------------------------------------------------------------*/
+
+#define ALIGN_SIZE      _Alignof(max_align_t)
+#define ALIGN_UP(x)     (((x) + ALIGN_SIZE - 1) & ~(ALIGN_SIZE - 1))
+#define HEADER_SIZE     ALIGN_UP(sizeof(Header))
+#define NUM_BLOCKS(self) ((self)->headSeq - (self)->tailSeq)
+#define TO_HEADER(ptr)  ((Header*) ((uint8_t*) (ptr) - HEADER_SIZE))
+
+/* Private functions prototypes ----------------------------------------------*/
+
+// returns the offset of a free range of size bytes, or the size of the buffer
+// if there is none
+INLINE size_t
+findSpace(RingAllocator* self, size_t size)
+{
+    size_t retval = self->size;
+
+    if (!NUM_BLOCKS(self))
+    {
+        // an empty ring starts over, so that the whole buffer is in one piece
+        self->head = 0;
+        self->tail = 0;
+        retval = (size <= self->size) ? 0 : self->size;
+    }
+    else if (self->head > self->tail)
+    {
+        if (self->size - self->head >= size)
+        {
+            retval = self->head;
+        }
+        else if (self->tail >= size)
+        {
+            retval = 0;
+        }
+    }
+    else if (self->tail - self->head >= size)
+    {
+        // head == tail here means that the ring is full
+        retval = self->head;
+    }
+    return retval;
+}
+
+// the allocated block the header belongs to, or NULL
+INLINE Header*
+findBlock(RingAllocator* self, void* ptr)
+{
+    Header* retval = NULL;
+    uint8_t* addr = (uint8_t*) ptr;
+
+    if (ptr != NULL
+        && addr >= self->buffer + HEADER_SIZE
+        && addr < self->buffer + self->size
+        && !((addr - self->buffer) % ALIGN_SIZE))
+    {
+        Header* header = TO_HEADER(ptr);
+        size_t index = header->seq - self->tailSeq;
+
+        if (index < NUM_BLOCKS(self)
+            && !(self->pending & ((uint64_t) 1 << index))
+            && self->offsets[header->seq % RingAllocator_MAX_BLOCKS]
+            == (size_t) ((uint8_t*) header - self->buffer))
+        {
+            retval = header;
+        }
+    }
+    return retval;
+}
+
+/* Private variables ---------------------------------------------------------*/
+
+static const Allocator_Vtable RingAllocator_vtable =
+{
+    .alloc        = RingAllocator_alloc,
+    .free         = RingAllocator_free,
+    .dtor         = RingAllocator_dtor,
+    .usableSize   = RingAllocator_usableSize
+};
+
+
+/* Public functions ----------------------------------------------------------*/
+
+#if !defined(Memory_Config_STATIC)
+bool
+RingAllocator_ctor(RingAllocator* self,
+                   size_t size)
+{
+    Debug_ASSERT_SELF(self);
+
+    bool retval = false;
+    void* buffer = Memory_alloc(size);
+
+    if (NULL == buffer)
+    {
+        retval = false;
+    }
+    else
+    {
+        retval = RingAllocator_ctorStatic(self, buffer, size);
+        self->isStatic = false;
+    }
+    if (!retval)
+    {
+        Memory_free(buffer);
+    }
+    return retval;
+}
+#endif
+
+bool
+RingAllocator_ctorStatic(RingAllocator* self,
+                         void* buffer,
+                         size_t size)
+{
+    Debug_ASSERT_SELF(self);
+
+    Debug_LOG_TRACE("%s: buffer @%p, size %zd", __func__, buffer, size);
+
+    bool retval = false;
+    size_t padding = ALIGN_UP((uintptr_t) buffer) - (uintptr_t) buffer;
+
+    if (NULL == buffer || size <= padding + HEADER_SIZE)
+    {
+        retval = false;
+    }
+    else
+    {
+        memset(self, 0, sizeof(*self));
+
+        // Memory_alloc() buffers need no padding, RingAllocator_dtor() frees
+        // the aligned address
+        self->buffer    = (uint8_t*) buffer + padding;
+        self->size      = (size - padding) & ~(ALIGN_SIZE - 1);
+        self->isStatic  = true;
+
+        self->parent.vtable = &RingAllocator_vtable;
+
+        retval = (self->size > HEADER_SIZE);
+    }
+    return retval;
+}
+
+void*
+RingAllocator_alloc(Allocator* allocator, size_t size)
+{
+    RingAllocator* self = (RingAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    void* retval = NULL;
+    size_t blockSize = HEADER_SIZE + ALIGN_UP(size);
+    size_t offset = self->size;
+
+    if (!size
+        || size > self->size
+        || NUM_BLOCKS(self) == RingAllocator_MAX_BLOCKS)
+    {
+        // do nothing
+    }
+    else if ((offset = findSpace(self, blockSize)) == self->size)
+    {
+        Debug_LOG_WARNING("%s: size %zd, allocation failed, head %zd, tail %zd",
+                          __func__, size, self->head, self->tail);
+    }
+    else
+    {
+        Header* header = (Header*) (self->buffer + offset);
+
+        header->seq  = self->headSeq;
+        header->size = ALIGN_UP(size);
+        self->offsets[self->headSeq % RingAllocator_MAX_BLOCKS] = offset;
+        self->headSeq++;
+        self->head = offset + blockSize;
+
+        retval = (uint8_t*) header + HEADER_SIZE;
+    }
+    return retval;
+}
+
+void
+RingAllocator_free(Allocator* allocator, void* ptr)
+{
+    RingAllocator* self = (RingAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    Header* header = findBlock(self, ptr);
+
+    if (NULL == ptr)
+    {
+        // do nothing
+    }
+    else if (NULL == header)
+    {
+        Debug_LOG_WARNING("%s: ptr @%p was not allocated!", __func__, ptr);
+    }
+    else
+    {
+        self->pending |= (uint64_t) 1 << (header->seq - self->tailSeq);
+
+        if (self->pending & 1)
+        {
+            // the oldest block and the freed ones right after it go at once
+            size_t count = (~self->pending)
+                           ? (size_t) __builtin_ctzll(~self->pending)
+                           : RingAllocator_MAX_BLOCKS;
+
+            self->pending = (count < RingAllocator_MAX_BLOCKS)
+                            ? self->pending >> count
+                            : 0;
+            self->tailSeq += count;
+            self->tail = NUM_BLOCKS(self)
+                         ? self->offsets[self->tailSeq
+                                         % RingAllocator_MAX_BLOCKS]
+                         : self->head;
+        }
+    }
+}
+
+size_t
+RingAllocator_usableSize(Allocator* allocator, void* ptr)
+{
+    RingAllocator* self = (RingAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    Header* header = findBlock(self, ptr);
+
+    return (header != NULL) ? header->size : 0;
+}
+
+void
+RingAllocator_dtor(Allocator* allocator)
+{
+    RingAllocator* self = (RingAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+#if !defined(Memory_Config_STATIC)
+    if (!self->isStatic)
+    {
+        Memory_free(self->buffer);
+    }
+#endif
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+
+
+///@}
@@ -0,0 +1,323 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/ShardedAllocator.h"
+#include "lib_debug/Debug.h"
+#include "lib_mem/Memory.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/* Defines -------------------------------------------------------------------*/
+
+#define ARENA_BEGIN(arena)  ((uint8_t*) (arena)->bmAllocator.baseAddr)
+#define ARENA_END(arena)\
+    (ARENA_BEGIN(arena) + (arena)->bmAllocator.numElements\
+     * (arena)->bmAllocator.elementSize)
+
+/* Private functions prototypes ----------------------------------------------*/
+
+INLINE void
+lockArena(ShardedAllocator_Arena* arena)
+{
+    Mutex_acquire(arena->mutex);
+    __atomic_store_n(&arena->busy, true, __ATOMIC_RELAXED);
+}
+
+INLINE void
+unlockArena(ShardedAllocator_Arena* arena)
+{
+    __atomic_store_n(&arena->busy, false, __ATOMIC_RELAXED);
+    Mutex_release(arena->mutex);
+}
+
+static void
+sortArenas(ShardedAllocator* self);
+
+static ShardedAllocator_Arena*
+findArena(ShardedAllocator* self, void* ptr);
+
+static size_t
+getHomeArena(ShardedAllocator* self);
+
+/* Private variables ---------------------------------------------------------*/
+
+// home arena of the calling thread plus one, 0 until it got one. It is shared
+// by all the instances and taken modulo their number of arenas
+static _Thread_local size_t homeArena;
+
+static const Allocator_Vtable ShardedAllocator_vtable =
+{
+    .alloc        = ShardedAllocator_alloc,
+    .free         = ShardedAllocator_free,
+    .dtor         = ShardedAllocator_dtor,
+    .usableSize   = ShardedAllocator_usableSize
+};
+
+
+/* Public functions ----------------------------------------------------------*/
+
+#if !defined(Memory_Config_STATIC)
+bool
+ShardedAllocator_ctor(ShardedAllocator* self,
+                      ShardedAllocator_Arena* arenas,
+                      size_t numArenas,
+                      size_t elementSize,
+                      size_t numElements,
+                      Mutex** mutexes)
+{
+    Debug_ASSERT_SELF(self);
+
+    bool retval = (arenas != NULL && mutexes != NULL && numArenas > 0);
+    size_t constructed = 0;
+
+    for (; retval && constructed < numArenas; constructed++)
+    {
+        ShardedAllocator_Arena* arena = &arenas[constructed];
+
+        arena->mutex = mutexes[constructed];
+        arena->busy  = false;
+        if (NULL == arena->mutex
+            || !BitmapAllocator_ctor(&arena->bmAllocator,
+                                     elementSize,
+                                     numElements))
+        {
+            retval = false;
+            break;
+        }
+    }
+    if (retval)
+    {
+        retval = ShardedAllocator_ctorStatic(self, arenas, numArenas);
+        self->isStatic = false;
+    }
+    else
+    {
+        while (constructed > 0)
+        {
+            constructed--;
+            BitmapAllocator_dtor(
+                BitmapAllocator_TO_ALLOCATOR(&arenas[constructed].bmAllocator));
+        }
+    }
+    return retval;
+}
+#endif
+
+bool
+ShardedAllocator_ctorStatic(ShardedAllocator* self,
+                            ShardedAllocator_Arena* arenas,
+                            size_t numArenas)
+{
+    Debug_ASSERT_SELF(self);
+
+    bool retval = (arenas != NULL && numArenas > 0);
+
+    for (size_t i = 0; retval && i < numArenas; i++)
+    {
+        arenas[i].busy = false;
+        retval = (arenas[i].mutex != NULL);
+    }
+    if (retval)
+    {
+        self->arenas    = arenas;
+        self->numArenas = numArenas;
+        self->nextHome  = 0;
+        self->isStatic  = true;
+        sortArenas(self);
+
+        for (size_t i = 1; retval && i < numArenas; i++)
+        {
+            retval = (ARENA_END(&arenas[i - 1]) <= ARENA_BEGIN(&arenas[i]));
+        }
+    }
+    if (retval)
+    {
+        self->parent.vtable = &ShardedAllocator_vtable;
+    }
+    return retval;
+}
+
+void*
+ShardedAllocator_alloc(Allocator* allocator, size_t size)
+{
+    ShardedAllocator* self = (ShardedAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    void* retval = NULL;
+    size_t home = getHomeArena(self);
+    size_t index = home;
+    bool skipped = false;
+
+    // first round, the busy arenas are left to the threads holding them
+    for (size_t i = 0; NULL == retval && i < self->numArenas; i++)
+    {
+        index = (home + i) % self->numArenas;
+        ShardedAllocator_Arena* arena = &self->arenas[index];
+
+        if (__atomic_load_n(&arena->busy, __ATOMIC_RELAXED))
+        {
+            skipped = true;
+        }
+        else
+        {
+            lockArena(arena);
+            retval = BitmapAllocator_alloc(
+                         BitmapAllocator_TO_ALLOCATOR(&arena->bmAllocator),
+                         size);
+            unlockArena(arena);
+        }
+    }
+    // second round, wait for them
+    for (size_t i = 0; skipped && NULL == retval && i < self->numArenas; i++)
+    {
+        index = (home + i) % self->numArenas;
+        ShardedAllocator_Arena* arena = &self->arenas[index];
+
+        lockArena(arena);
+        retval = BitmapAllocator_alloc(
+                     BitmapAllocator_TO_ALLOCATOR(&arena->bmAllocator),
+                     size);
+        unlockArena(arena);
+    }
+    if (retval != NULL && index != home)
+    {
+        homeArena = index + 1;
+    }
+    return retval;
+}
+
+void
+ShardedAllocator_free(Allocator* allocator, void* ptr)
+{
+    ShardedAllocator* self = (ShardedAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    ShardedAllocator_Arena* arena = findArena(self, ptr);
+
+    if (NULL == ptr)
+    {
+        // do nothing
+    }
+    else if (NULL == arena)
+    {
+        Debug_LOG_WARNING("%s: ptr @%p was not allocated!", __func__, ptr);
+    }
+    else
+    {
+        lockArena(arena);
+        BitmapAllocator_free(BitmapAllocator_TO_ALLOCATOR(&arena->bmAllocator),
+                             ptr);
+        unlockArena(arena);
+    }
+}
+
+size_t
+ShardedAllocator_usableSize(Allocator* allocator, void* ptr)
+{
+    ShardedAllocator* self = (ShardedAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    size_t retval = 0;
+    ShardedAllocator_Arena* arena = findArena(self, ptr);
+
+    if (arena != NULL)
+    {
+        lockArena(arena);
+        retval = BitmapAllocator_usableSize(
+                     BitmapAllocator_TO_ALLOCATOR(&arena->bmAllocator),
+                     ptr);
+        unlockArena(arena);
+    }
+    return retval;
+}
+
+void
+ShardedAllocator_dtor(Allocator* allocator)
+{
+    ShardedAllocator* self = (ShardedAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+#if !defined(Memory_Config_STATIC)
+    if (!self->isStatic)
+    {
+        for (size_t i = 0; i < self->numArenas; i++)
+        {
+            BitmapAllocator_dtor(
+                BitmapAllocator_TO_ALLOCATOR(&self->arenas[i].bmAllocator));
+        }
+    }
+#endif
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+
+// insertion sort by base address, there are only a few arenas
+static void
+sortArenas(ShardedAllocator* self)
+{
+    for (size_t i = 1; i < self->numArenas; i++)
+    {
+        ShardedAllocator_Arena arena = self->arenas[i];
+        size_t j = i;
+
+        for (; j > 0 && ARENA_BEGIN(&self->arenas[j - 1]) > ARENA_BEGIN(&arena);
+             j--)
+        {
+            self->arenas[j] = self->arenas[j - 1];
+        }
+        self->arenas[j] = arena;
+    }
+}
+
+// binary search for the arena whose range holds ptr, NULL if there is none
+static ShardedAllocator_Arena*
+findArena(ShardedAllocator* self, void* ptr)
+{
+    size_t low = 0;
+    size_t high = self->numArenas;
+
+    while (ptr != NULL && low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        ShardedAllocator_Arena* arena = &self->arenas[mid];
+
+        if ((uint8_t*) ptr < ARENA_BEGIN(arena))
+        {
+            high = mid;
+        }
+        else if ((uint8_t*) ptr >= ARENA_END(arena))
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            return arena;
+        }
+    }
+    return NULL;
+}
+
+// hands out the arenas round robin on the first request of a thread
+static size_t
+getHomeArena(ShardedAllocator* self)
+{
+    if (!homeArena)
+    {
+        homeArena = __atomic_fetch_add(&self->nextHome, 1, __ATOMIC_RELAXED)
+                    % self->numArenas + 1;
+    }
+    return (homeArena - 1) % self->numArenas;
+}
+
+
+///@}
@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/SizeClassAllocator.h"
+#include "lib_debug/Debug.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/* Defines -------------------------------------------------------------------*/
+
+#define CLASS_BEGIN(cls)    ((uint8_t*) (cls)->base)
+#define CLASS_END(cls)      (CLASS_BEGIN(cls) + (cls)->size)
+
+/* Private functions prototypes ----------------------------------------------*/
+
+INLINE bool
+overlaps(const SizeClassAllocator_Class* a, const SizeClassAllocator_Class* b)
+{
+    return CLASS_BEGIN(a) < CLASS_END(b) && CLASS_BEGIN(b) < CLASS_END(a);
+}
+
+// binary search for the first class covering size, numClasses if there is
+// none
+static size_t
+findClassBySize(SizeClassAllocator* self, size_t size);
+
+// the class whose range holds ptr, NULL if there is none
+static const SizeClassAllocator_Class*
+findClassByAddr(SizeClassAllocator* self, void* ptr);
+
+/* Private variables ---------------------------------------------------------*/
+
+static const Allocator_Vtable SizeClassAllocator_vtable =
+{
+    .alloc        = SizeClassAllocator_alloc,
+    .free         = SizeClassAllocator_free,
+    .dtor         = SizeClassAllocator_dtor,
+    .usableSize   = SizeClassAllocator_usableSize,
+    .allocAligned = SizeClassAllocator_allocAligned
+};
+
+
+/* Public functions ----------------------------------------------------------*/
+bool
+SizeClassAllocator_ctor(SizeClassAllocator* self,
+                        const SizeClassAllocator_Class* classes,
+                        size_t numClasses,
+                        Allocator* fallback)
+{
+    Debug_ASSERT_SELF(self);
+
+    bool retval = (classes != NULL && numClasses > 0);
+
+    for (size_t i = 0; retval && i < numClasses; i++)
+    {
+        retval = (classes[i].allocator != NULL
+                  && classes[i].base != NULL
+                  && classes[i].size > 0
+                  && (!i || classes[i].maxSize > classes[i - 1].maxSize));
+
+        for (size_t j = 0; retval && j < i; j++)
+        {
+            retval = !overlaps(&classes[i], &classes[j]);
+        }
+    }
+    if (retval)
+    {
+        self->classes       = classes;
+        self->numClasses    = numClasses;
+        self->fallback      = fallback;
+        self->parent.vtable = &SizeClassAllocator_vtable;
+    }
+    return retval;
+}
+
+void*
+SizeClassAllocator_alloc(Allocator* allocator, size_t size)
+{
+    SizeClassAllocator* self = (SizeClassAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    void* retval = NULL;
+    size_t index = findClassBySize(self, size);
+
+    if (!size)
+    {
+        // do nothing
+    }
+    else
+    {
+        if (index < self->numClasses)
+        {
+            retval = Allocator_alloc(self->classes[index].allocator, size);
+        }
+        if (NULL == retval && self->fallback != NULL)
+        {
+            retval = Allocator_alloc(self->fallback, size);
+        }
+    }
+    return retval;
+}
+
+void*
+SizeClassAllocator_allocAligned(Allocator* allocator,
+                                size_t size,
+                                size_t alignment)
+{
+    SizeClassAllocator* self = (SizeClassAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    void* retval = NULL;
+    size_t index = findClassBySize(self, size);
+
+    if (!size)
+    {
+        // do nothing
+    }
+    else
+    {
+        if (index < self->numClasses)
+        {
+            retval = Allocator_allocAligned(self->classes[index].allocator,
+                                            size,
+                                            alignment);
+        }
+        if (NULL == retval && self->fallback != NULL)
+        {
+            retval = Allocator_allocAligned(self->fallback, size, alignment);
+        }
+    }
+    return retval;
+}
+
+void
+SizeClassAllocator_free(Allocator* allocator, void* ptr)
+{
+    SizeClassAllocator* self = (SizeClassAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    const SizeClassAllocator_Class* cls = findClassByAddr(self, ptr);
+
+    if (NULL == ptr)
+    {
+        // do nothing
+    }
+    else if (cls != NULL)
+    {
+        Allocator_free(cls->allocator, ptr);
+    }
+    else if (self->fallback != NULL)
+    {
+        Allocator_free(self->fallback, ptr);
+    }
+    else
+    {
+        Debug_LOG_WARNING("%s: ptr @%p was not allocated!", __func__, ptr);
+    }
+}
+
+size_t
+SizeClassAllocator_usableSize(Allocator* allocator, void* ptr)
+{
+    SizeClassAllocator* self = (SizeClassAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    size_t retval = 0;
+    const SizeClassAllocator_Class* cls = findClassByAddr(self, ptr);
+
+    if (cls != NULL)
+    {
+        retval = Allocator_usableSize(cls->allocator, ptr);
+    }
+    else if (self->fallback != NULL)
+    {
+        retval = Allocator_usableSize(self->fallback, ptr);
+    }
+    return retval;
+}
+
+void
+SizeClassAllocator_dtor(Allocator* allocator)
+{
+    Debug_ASSERT_SELF(allocator);
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+
+static size_t
+findClassBySize(SizeClassAllocator* self, size_t size)
+{
+    size_t low = 0;
+    size_t high = self->numClasses;
+
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+
+        if (self->classes[mid].maxSize < size)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// there are only a few classes, a linear search beats sorting them by address
+static const SizeClassAllocator_Class*
+findClassByAddr(SizeClassAllocator* self, void* ptr)
+{
+    for (size_t i = 0; ptr != NULL && i < self->numClasses; i++)
+    {
+        const SizeClassAllocator_Class* cls = &self->classes[i];
+
+        if ((uint8_t*) ptr >= CLASS_BEGIN(cls) && (uint8_t*) ptr < CLASS_END(cls))
+        {
+            return cls;
+        }
+    }
+    return NULL;
+}
+
+
+///@}
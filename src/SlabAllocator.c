@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/SlabAllocator.h"
+#include "lib_debug/Debug.h"
+#include "lib_mem/Memory.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+
+/* Defines -------------------------------------------------------------------*/
+
+#define TO_MEM_ADDR(self, slot)\
+    ((uint8_t*) (self)->baseAddr + (slot) * (self)->slotSize)
+
+/* Private functions prototypes ----------------------------------------------*/
+
+// the slots may be unaligned for a pointer, the links are copied bytewise
+INLINE void*
+getNext(void* slot)
+{
+    void* next;
+
+    memcpy(&next, slot, sizeof(next));
+    return next;
+}
+
+INLINE void
+setNext(void* slot, void* next)
+{
+    memcpy(slot, &next, sizeof(next));
+}
+
+// true if ptr is the start of a slot handed out before
+INLINE bool
+isSlot(SlabAllocator* self, void* ptr)
+{
+    uintptr_t offset = (uintptr_t) ptr - (uintptr_t) self->baseAddr;
+
+    return (ptr != NULL
+            && (uint8_t*) ptr >= (uint8_t*) self->baseAddr
+            && offset < self->usedSlots * self->slotSize
+            && !(offset % self->slotSize));
+}
+
+/* Private variables ---------------------------------------------------------*/
+
+static const Allocator_Vtable SlabAllocator_vtable =
+{
+    .alloc        = SlabAllocator_alloc,
+    .free         = SlabAllocator_free,
+    .dtor         = SlabAllocator_dtor,
+    .usableSize   = SlabAllocator_usableSize
+};
+
+
+/* Public functions ----------------------------------------------------------*/
+
+#if !defined(Memory_Config_STATIC)
+bool
+SlabAllocator_ctor(SlabAllocator* self,
+                   size_t slotSize,
+                   size_t numSlots)
+{
+    Debug_ASSERT_SELF(self);
+
+    bool retval = false;
+    void* buffer = Memory_alloc(numSlots * slotSize);
+
+    if (NULL == buffer)
+    {
+        retval = false;
+    }
+    else
+    {
+        retval = SlabAllocator_ctorStatic(self, buffer, slotSize, numSlots);
+        self->isStatic = false;
+    }
+    if (!retval)
+    {
+        Memory_free(buffer);
+    }
+    return retval;
+}
+#endif
+
+bool
+SlabAllocator_ctorStatic(SlabAllocator* self,
+                         void* buffer,
+                         size_t slotSize,
+                         size_t numSlots)
+{
+    Debug_ASSERT_SELF(self);
+
+    Debug_LOG_TRACE("%s: buffer @%p, slotSize %zd, numSlots %zd",
+                    __func__, buffer, slotSize, numSlots);
+
+    bool retval = false;
+
+    if (!numSlots
+        || NULL == buffer
+        || slotSize < sizeof(void*))
+    {
+        retval = false;
+    }
+    else
+    {
+        memset(self, 0, sizeof(*self));
+
+        self->baseAddr  = buffer;
+        self->slotSize  = slotSize;
+        self->numSlots  = numSlots;
+        self->freeList  = NULL;
+        self->isStatic  = true;
+
+        self->parent.vtable = &SlabAllocator_vtable;
+
+        retval = true;
+    }
+    return retval;
+}
+
+void*
+SlabAllocator_alloc(Allocator* allocator, size_t size)
+{
+    SlabAllocator* self = (SlabAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    void* retval = NULL;
+
+    if (!size || size > self->slotSize)
+    {
+        // do nothing
+    }
+    else if (self->freeList != NULL)
+    {
+        retval = self->freeList;
+        self->freeList = getNext(retval);
+    }
+    else if (self->usedSlots < self->numSlots)
+    {
+        retval = TO_MEM_ADDR(self, self->usedSlots);
+        self->usedSlots++;
+    }
+
+    if (NULL == retval)
+    {
+        Debug_LOG_WARNING("%s: size %zd, allocation failed, allocated %zd out of %zd slots",
+                          __func__,
+                          size,
+                          self->allocatedSlots,
+                          self->numSlots);
+    }
+    else
+    {
+        self->allocatedSlots++;
+    }
+    return retval;
+}
+
+void
+SlabAllocator_free(Allocator* allocator, void* ptr)
+{
+    SlabAllocator* self = (SlabAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    if (NULL == ptr)
+    {
+        // do nothing
+    }
+    else if (!isSlot(self, ptr))
+    {
+        Debug_LOG_WARNING("%s: ptr @%p was not allocated!", __func__, ptr);
+    }
+    else
+    {
+        Debug_ASSERT(self->allocatedSlots > 0);
+
+        setNext(ptr, self->freeList);
+        self->freeList = ptr;
+        self->allocatedSlots--;
+    }
+}
+
+size_t
+SlabAllocator_usableSize(Allocator* allocator, void* ptr)
+{
+    SlabAllocator* self = (SlabAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    return isSlot(self, ptr) ? self->slotSize : 0;
+}
+
+void
+SlabAllocator_dtor(Allocator* allocator)
+{
+    SlabAllocator* self = (SlabAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+#if !defined(Memory_Config_STATIC)
+    if (!self->isStatic)
+    {
+        Memory_free(self->baseAddr);
+    }
+#endif
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+
+
+///@}
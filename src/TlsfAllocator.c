@@ -0,0 +1,500 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/TlsfAllocator.h"
+#include "lib_debug/Debug.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+
+/* Private types -------------------------------------------------------------*/
+
+// the blocks are laid out back to back, a zero sized used one ends the pool
+struct TlsfAllocator_Block
+{
+    // the block right before this one in memory, NULL for the first one
+    TlsfAllocator_Block*    prevPhys;
+    // bytes after the header, the lowest bit flags a free block
+    size_t                  sizeAndFlags;
+    // only in free blocks, they take the place of the first payload bytes
+    TlsfAllocator_Block*    nextFree;
+    TlsfAllocator_Block*    prevFree;
+};
+
+/* Defines -------------------------------------------------------------------*/
+
+#define ALIGN_SIZE          TlsfAllocator_ALIGN_SIZE
+#define SL_LOG2             TlsfAllocator_SL_LOG2
+#define SL_COUNT            TlsfAllocator_SL_COUNT
+#define FL_SHIFT            TlsfAllocator_FL_SHIFT
+#define FL_COUNT            TlsfAllocator_FL_COUNT
+#define SMALL_BLOCK_SIZE    ((size_t) 1 << FL_SHIFT)
+#define BLOCK_SIZE_MAX      ((size_t) 1 << TlsfAllocator_FL_MAX)
+
+#define HEADER_SIZE         offsetof(TlsfAllocator_Block, nextFree)
+// a free block has to hold the list links
+#define BLOCK_SIZE_MIN      (sizeof(TlsfAllocator_Block) - HEADER_SIZE)
+#define FREE_BIT            ((size_t) 1)
+
+#define TO_BLOCK(ptr)       ((TlsfAllocator_Block*) ((uint8_t*) (ptr)\
+                                                     - HEADER_SIZE))
+#define TO_PTR(block)       ((void*) ((uint8_t*) (block) + HEADER_SIZE))
+
+_Static_assert(HEADER_SIZE == ALIGN_SIZE, "header breaks the alignment");
+_Static_assert(BLOCK_SIZE_MIN <= ALIGN_SIZE, "no room for the links");
+
+/* Private functions prototypes ----------------------------------------------*/
+
+INLINE size_t
+getSize(const TlsfAllocator_Block* block)
+{
+    return block->sizeAndFlags & ~FREE_BIT;
+}
+
+INLINE void
+setSize(TlsfAllocator_Block* block, size_t size)
+{
+    block->sizeAndFlags = size | (block->sizeAndFlags & FREE_BIT);
+}
+
+INLINE bool
+isFree(const TlsfAllocator_Block* block)
+{
+    return block->sizeAndFlags & FREE_BIT;
+}
+
+INLINE void
+setFree(TlsfAllocator_Block* block, bool free)
+{
+    block->sizeAndFlags = getSize(block) | (free ? FREE_BIT : 0);
+}
+
+INLINE TlsfAllocator_Block*
+getNextPhys(const TlsfAllocator_Block* block)
+{
+    return (TlsfAllocator_Block*) ((uint8_t*) TO_PTR(block) + getSize(block));
+}
+
+// index of the highest set bit, word must not be 0
+INLINE unsigned
+findLastSet(size_t word)
+{
+    Debug_ASSERT(word != 0);
+
+    return (sizeof(word) <= sizeof(unsigned int))
+           ? (unsigned) (sizeof(unsigned int) * 8 - 1 - __builtin_clz(word))
+           : (sizeof(word) <= sizeof(unsigned long))
+           ? (unsigned) (sizeof(unsigned long) * 8 - 1 - __builtin_clzl(word))
+           : (unsigned) (sizeof(unsigned long long) * 8 - 1
+                         - __builtin_clzll(word));
+}
+
+// index of the lowest set bit, word must not be 0
+INLINE unsigned
+findFirstSet(uint32_t word)
+{
+    Debug_ASSERT(word != 0);
+
+    return (unsigned) __builtin_ctz(word);
+}
+
+INLINE size_t
+alignUp(size_t size)
+{
+    return (size + ALIGN_SIZE - 1) & ~(ALIGN_SIZE - 1);
+}
+
+// lists holding the blocks of the given size
+INLINE void
+mapInsert(size_t size, unsigned* fl, unsigned* sl)
+{
+    if (size < SMALL_BLOCK_SIZE)
+    {
+        *fl = 0;
+        *sl = (unsigned) (size / (SMALL_BLOCK_SIZE / SL_COUNT));
+    }
+    else
+    {
+        unsigned last = findLastSet(size);
+
+        *sl = (unsigned) (size >> (last - SL_LOG2)) ^ SL_COUNT;
+        *fl = last - (FL_SHIFT - 1);
+    }
+}
+
+// first lists whose blocks are all large enough for the given size, returns
+// false if there is none
+INLINE bool
+mapSearch(size_t size, unsigned* fl, unsigned* sl)
+{
+    if (size >= SMALL_BLOCK_SIZE)
+    {
+        size += ((size_t) 1 << (findLastSet(size) - SL_LOG2)) - 1;
+    }
+    mapInsert(size, fl, sl);
+
+    return *fl < FL_COUNT;
+}
+
+INLINE void
+insertFreeBlock(TlsfAllocator* self, TlsfAllocator_Block* block)
+{
+    unsigned fl, sl;
+    mapInsert(getSize(block), &fl, &sl);
+    TlsfAllocator_Block* head = self->freeLists[fl][sl];
+
+    block->prevFree = NULL;
+    block->nextFree = head;
+    if (head != NULL)
+    {
+        head->prevFree = block;
+    }
+    self->freeLists[fl][sl] = block;
+    self->flBitmap     |= (uint32_t) 1 << fl;
+    self->slBitmaps[fl] |= (uint32_t) 1 << sl;
+    self->freeBytes += getSize(block);
+    setFree(block, true);
+}
+
+INLINE void
+removeFreeBlock(TlsfAllocator* self, TlsfAllocator_Block* block)
+{
+    unsigned fl, sl;
+    mapInsert(getSize(block), &fl, &sl);
+
+    if (block->prevFree != NULL)
+    {
+        block->prevFree->nextFree = block->nextFree;
+    }
+    else
+    {
+        self->freeLists[fl][sl] = block->nextFree;
+        if (NULL == block->nextFree)
+        {
+            self->slBitmaps[fl] &= ~((uint32_t) 1 << sl);
+            if (!self->slBitmaps[fl])
+            {
+                self->flBitmap &= ~((uint32_t) 1 << fl);
+            }
+        }
+    }
+    if (block->nextFree != NULL)
+    {
+        block->nextFree->prevFree = block->prevFree;
+    }
+    self->freeBytes -= getSize(block);
+    setFree(block, false);
+}
+
+// puts what is left of a used block past size bytes back as a free block,
+// merged with the next one if that is free
+INLINE void
+trimBlock(TlsfAllocator* self, TlsfAllocator_Block* block, size_t size)
+{
+    if (getSize(block) >= size + HEADER_SIZE + BLOCK_SIZE_MIN)
+    {
+        TlsfAllocator_Block* rest =
+            (TlsfAllocator_Block*) ((uint8_t*) TO_PTR(block) + size);
+        TlsfAllocator_Block* next = getNextPhys(block);
+
+        rest->prevPhys = block;
+        rest->sizeAndFlags = getSize(block) - size - HEADER_SIZE;
+        setSize(block, size);
+
+        if (isFree(next))
+        {
+            removeFreeBlock(self, next);
+            setSize(rest, getSize(rest) + HEADER_SIZE + getSize(next));
+            next = getNextPhys(rest);
+        }
+        next->prevPhys = rest;
+        insertFreeBlock(self, rest);
+    }
+}
+
+static TlsfAllocator_Block*
+findFreeBlock(TlsfAllocator* self, size_t size);
+
+static bool
+isUsedBlock(TlsfAllocator* self, void* ptr);
+
+/* Private variables ---------------------------------------------------------*/
+
+static const Allocator_Vtable TlsfAllocator_vtable =
+{
+    .alloc        = TlsfAllocator_alloc,
+    .free         = TlsfAllocator_free,
+    .dtor         = TlsfAllocator_dtor,
+    .realloc      = TlsfAllocator_realloc,
+    .usableSize   = TlsfAllocator_usableSize
+};
+
+
+/* Public functions ----------------------------------------------------------*/
+bool
+TlsfAllocator_ctorStatic(TlsfAllocator* self,
+                         void* buffer,
+                         size_t size)
+{
+    Debug_ASSERT_SELF(self);
+
+    Debug_LOG_TRACE("%s: buffer @%p, size %zd", __func__, buffer, size);
+
+    bool retval = false;
+    size_t padding = (ALIGN_SIZE - ((uintptr_t) buffer & (ALIGN_SIZE - 1)))
+                     & (ALIGN_SIZE - 1);
+    // the first block and the end marker take a header each
+    size_t blockSize = (size > padding + 2 * HEADER_SIZE)
+                       ? (size - padding - 2 * HEADER_SIZE) & ~(ALIGN_SIZE - 1)
+                       : 0;
+
+    if (NULL == buffer
+        || blockSize < BLOCK_SIZE_MIN
+        || blockSize >= BLOCK_SIZE_MAX)
+    {
+        retval = false;
+    }
+    else
+    {
+        memset(self, 0, sizeof(*self));
+
+        TlsfAllocator_Block* block =
+            (TlsfAllocator_Block*) ((uint8_t*) buffer + padding);
+
+        block->prevPhys     = NULL;
+        block->sizeAndFlags = blockSize;
+
+        TlsfAllocator_Block* end = getNextPhys(block);
+        end->prevPhys       = block;
+        end->sizeAndFlags   = 0;
+
+        self->baseAddr  = buffer;
+        self->size      = size;
+        insertFreeBlock(self, block);
+
+        self->parent.vtable = &TlsfAllocator_vtable;
+
+        retval = true;
+    }
+    return retval;
+}
+
+void*
+TlsfAllocator_alloc(Allocator* allocator, size_t size)
+{
+    TlsfAllocator* self = (TlsfAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    void* retval = NULL;
+    TlsfAllocator_Block* block = NULL;
+
+    if (!size || size >= BLOCK_SIZE_MAX)
+    {
+        // do nothing
+    }
+    else if (NULL == (block = findFreeBlock(self, alignUp(size))))
+    {
+        Debug_LOG_WARNING("%s: size %zd, allocation failed, used %zd, free %zd bytes",
+                          __func__,
+                          size,
+                          self->usedBytes,
+                          self->freeBytes);
+    }
+    else
+    {
+        removeFreeBlock(self, block);
+        trimBlock(self, block, alignUp(size));
+        self->usedBytes += getSize(block);
+        retval = TO_PTR(block);
+    }
+    return retval;
+}
+
+void
+TlsfAllocator_free(Allocator* allocator, void* ptr)
+{
+    TlsfAllocator* self = (TlsfAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    if (NULL == ptr)
+    {
+        // do nothing
+    }
+    else if (!isUsedBlock(self, ptr))
+    {
+        Debug_LOG_WARNING("%s: ptr @%p was not allocated!", __func__, ptr);
+    }
+    else
+    {
+        TlsfAllocator_Block* block = TO_BLOCK(ptr);
+        TlsfAllocator_Block* prev = block->prevPhys;
+        TlsfAllocator_Block* next = getNextPhys(block);
+
+        self->usedBytes -= getSize(block);
+
+        if (prev != NULL && isFree(prev))
+        {
+            removeFreeBlock(self, prev);
+            setSize(prev, getSize(prev) + HEADER_SIZE + getSize(block));
+            block = prev;
+        }
+        if (isFree(next))
+        {
+            removeFreeBlock(self, next);
+            setSize(block, getSize(block) + HEADER_SIZE + getSize(next));
+        }
+        getNextPhys(block)->prevPhys = block;
+        insertFreeBlock(self, block);
+    }
+}
+
+void*
+TlsfAllocator_realloc(Allocator* allocator, void* ptr, size_t size)
+{
+    TlsfAllocator* self = (TlsfAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    void* retval = NULL;
+
+    if (NULL == ptr)
+    {
+        retval = TlsfAllocator_alloc(allocator, size);
+    }
+    else if (!size)
+    {
+        TlsfAllocator_free(allocator, ptr);
+    }
+    else if (!isUsedBlock(self, ptr) || size >= BLOCK_SIZE_MAX)
+    {
+        // do nothing
+    }
+    else
+    {
+        TlsfAllocator_Block* block = TO_BLOCK(ptr);
+        TlsfAllocator_Block* next = getNextPhys(block);
+        size_t oldSize = getSize(block);
+        size_t newSize = alignUp(size);
+
+        if (newSize > oldSize
+            && isFree(next)
+            && oldSize + HEADER_SIZE + getSize(next) >= newSize)
+        {
+            removeFreeBlock(self, next);
+            setSize(block, oldSize + HEADER_SIZE + getSize(next));
+            getNextPhys(block)->prevPhys = block;
+        }
+        if (newSize <= getSize(block))
+        {
+            trimBlock(self, block, newSize);
+            self->usedBytes = self->usedBytes - oldSize + getSize(block);
+            retval = ptr;
+        }
+        else
+        {
+            retval = TlsfAllocator_alloc(allocator, size);
+            if (retval != NULL)
+            {
+                memcpy(retval, ptr, oldSize);
+                TlsfAllocator_free(allocator, ptr);
+            }
+        }
+    }
+    return retval;
+}
+
+size_t
+TlsfAllocator_usableSize(Allocator* allocator, void* ptr)
+{
+    TlsfAllocator* self = (TlsfAllocator*) allocator;
+    Debug_ASSERT_SELF(self);
+
+    return isUsedBlock(self, ptr) ? getSize(TO_BLOCK(ptr)) : 0;
+}
+
+size_t
+TlsfAllocator_getUsedBytes(const TlsfAllocator* self)
+{
+    Debug_ASSERT_SELF(self);
+
+    return self->usedBytes;
+}
+
+size_t
+TlsfAllocator_getFreeBytes(const TlsfAllocator* self)
+{
+    Debug_ASSERT_SELF(self);
+
+    return self->freeBytes;
+}
+
+void
+TlsfAllocator_dtor(Allocator* allocator)
+{
+    Debug_ASSERT_SELF(allocator);
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+
+// a block of the first non empty list whose blocks all have at least size
+// bytes, NULL if there is none
+static TlsfAllocator_Block*
+findFreeBlock(TlsfAllocator* self, size_t size)
+{
+    TlsfAllocator_Block* retval = NULL;
+    unsigned fl, sl;
+
+    if (size < BLOCK_SIZE_MIN)
+    {
+        size = BLOCK_SIZE_MIN;
+    }
+    if (mapSearch(size, &fl, &sl))
+    {
+        uint32_t slMap = self->slBitmaps[fl] & (~(uint32_t) 0 << sl);
+
+        if (!slMap)
+        {
+            // the shift by 32 would be undefined
+            uint32_t flMap = (fl + 1 < 32)
+                             ? self->flBitmap & (~(uint32_t) 0 << (fl + 1))
+                             : 0;
+            if (flMap)
+            {
+                fl = findFirstSet(flMap);
+                slMap = self->slBitmaps[fl];
+            }
+        }
+        if (slMap)
+        {
+            retval = self->freeLists[fl][findFirstSet(slMap)];
+        }
+    }
+    return retval;
+}
+
+// checks that ptr is in the pool and looks like the start of a used block,
+// the check does not walk the pool
+static bool
+isUsedBlock(TlsfAllocator* self, void* ptr)
+{
+    uint8_t* begin = (uint8_t*) self->baseAddr + HEADER_SIZE;
+    uint8_t* end = (uint8_t*) self->baseAddr + self->size - HEADER_SIZE;
+
+    return (ptr != NULL
+            && (uint8_t*) ptr >= begin
+            && (uint8_t*) ptr < end
+            && !((uintptr_t) ptr & (ALIGN_SIZE - 1))
+            && !isFree(TO_BLOCK(ptr))
+            && getSize(TO_BLOCK(ptr)) > 0);
+}
+
+
+///@}
@@ -0,0 +1,511 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/*
+ * Replays a trace recorded with AllocatorTrace on one of the allocators of
+ * the targets table and reports the latency and the failures of each kind of
+ * request.
+ *
+ * usage: <trace file> <elementSize> <numElements> [target]
+ *
+ * The target defaults to first-fit. The allocators get elementSize *
+ * numElements bytes, for the BitmapAllocator based ones as numElements
+ * elements of elementSize bytes.
+ *
+ * The trace file is the array of AllocatorTrace_Record read from the ring, as
+ * written by the machine that recorded it. The recorded addresses are only
+ * used to match a free with its alloc, the requests whose block could not be
+ * allocated during the replay are skipped.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_mem/AllocatorSafe.h"
+#include "lib_mem/AllocatorTrace.h"
+#include "lib_mem/BitmapAllocator.h"
+#include "lib_mem/TlsfAllocator.h"
+#include "lib_osal/Mutex.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Defines -------------------------------------------------------------------*/
+
+#define NUM_OPS (AllocatorTrace_Op_ALLOC_ALIGNED + 1)
+// marks a removed entry of the address map
+#define TOMBSTONE ((uintptr_t) -1)
+
+/* Private types -------------------------------------------------------------*/
+
+typedef struct
+{
+    size_t      count;
+    size_t      failed;
+    size_t      skipped;
+    uint64_t    totalNs;
+    uint64_t    maxNs;
+}
+OpStats;
+
+// maps the addresses of the trace to the ones of the replay, open addressing
+typedef struct
+{
+    uintptr_t*  keys;
+    void**      values;
+    size_t      mask;
+}
+AddrMap;
+
+// the allocator a trace is replayed on, with whatever it is built from
+typedef struct
+{
+    Allocator*      allocator;
+    // the allocator wrapped by a decorator, NULL if there is none
+    Allocator*      impl;
+    BitmapAllocator bmAllocator;
+    AllocatorSafe   safe;
+    TlsfAllocator   tlsf;
+    Mutex*          mutex;
+    void*           buffer;
+}
+Target;
+
+typedef bool
+(*Target_CtorT)(Target* self, size_t elementSize, size_t numElements);
+
+typedef struct
+{
+    const char*     name;
+    Target_CtorT    ctor;
+}
+Target_Factory;
+
+/* Private functions prototypes ----------------------------------------------*/
+
+static bool
+createFirstFit(Target* self, size_t elementSize, size_t numElements);
+
+static bool
+createNextFit(Target* self, size_t elementSize, size_t numElements);
+
+static bool
+createSummary(Target* self, size_t elementSize, size_t numElements);
+
+static bool
+createSafe(Target* self, size_t elementSize, size_t numElements);
+
+static bool
+createTlsf(Target* self, size_t elementSize, size_t numElements);
+
+/* Private variables ---------------------------------------------------------*/
+
+// a new allocator only needs a create function and an entry here
+static const Target_Factory targets[] =
+{
+    { "first-fit",  createFirstFit },
+    { "next-fit",   createNextFit },
+    { "summary",    createSummary },
+    { "safe",       createSafe },
+    { "tlsf",       createTlsf },
+};
+
+#define NUM_TARGETS (sizeof(targets) / sizeof(targets[0]))
+
+static const char* const opNames[NUM_OPS] =
+{
+    [AllocatorTrace_Op_ALLOC]           = "alloc",
+    [AllocatorTrace_Op_FREE]            = "free",
+    [AllocatorTrace_Op_REALLOC]         = "realloc",
+    [AllocatorTrace_Op_ALLOC_ALIGNED]   = "allocAligned",
+};
+
+/* Private functions ---------------------------------------------------------*/
+
+static uint64_t
+nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static size_t
+AddrMap_find(AddrMap* self, uintptr_t key)
+{
+    size_t i = (key >> 3) & self->mask;
+
+    while (self->keys[i] != 0 && self->keys[i] != key)
+    {
+        i = (i + 1) & self->mask;
+    }
+    return i;
+}
+
+static void
+AddrMap_put(AddrMap* self, uintptr_t key, void* value)
+{
+    size_t i = AddrMap_find(self, key);
+
+    if (0 == self->keys[i])
+    {
+        // reuse the first removed entry on the way, if any
+        size_t j = (key >> 3) & self->mask;
+
+        while (self->keys[j] != TOMBSTONE && j != i)
+        {
+            j = (j + 1) & self->mask;
+        }
+        i = j;
+    }
+    self->keys[i]   = key;
+    self->values[i] = value;
+}
+
+// returns NULL if the key is not there
+static void*
+AddrMap_take(AddrMap* self, uintptr_t key)
+{
+    size_t i = AddrMap_find(self, key);
+    void* retval = NULL;
+
+    if (key != 0 && key != TOMBSTONE && self->keys[i] == key)
+    {
+        retval = self->values[i];
+        self->keys[i] = TOMBSTONE;
+    }
+    return retval;
+}
+
+static void
+account(OpStats* stats, uint64_t start, bool failed)
+{
+    uint64_t ns = nowNs() - start;
+
+    stats->count++;
+    stats->failed  += failed ? 1 : 0;
+    stats->totalNs += ns;
+    stats->maxNs    = (ns > stats->maxNs) ? ns : stats->maxNs;
+}
+
+static void
+replay(Allocator* allocator,
+       const AllocatorTrace_Record* records,
+       size_t num,
+       AddrMap* map,
+       OpStats* stats)
+{
+    for (size_t i = 0; i < num; i++)
+    {
+        const AllocatorTrace_Record* rec = &records[i];
+        OpStats* opStats = &stats[(rec->op < NUM_OPS) ? rec->op : 0];
+        uint64_t start = 0;
+        void* ptr = NULL;
+
+        switch (rec->op)
+        {
+        case AllocatorTrace_Op_ALLOC:
+        case AllocatorTrace_Op_ALLOC_ALIGNED:
+            start = nowNs();
+            ptr = (AllocatorTrace_Op_ALLOC == rec->op)
+                  ? Allocator_alloc(allocator, rec->size)
+                  : Allocator_allocAligned(allocator, rec->size, rec->arg);
+            account(opStats, start, NULL == ptr && rec->size);
+            if (NULL == ptr)
+            {
+                // do nothing
+            }
+            else if (!rec->ptr)
+            {
+                // failed when recorded, nothing will free it
+                Allocator_free(allocator, ptr);
+            }
+            else
+            {
+                AddrMap_put(map, rec->ptr, ptr);
+            }
+            break;
+        case AllocatorTrace_Op_FREE:
+            ptr = AddrMap_take(map, rec->ptr);
+            if (NULL == ptr)
+            {
+                opStats->skipped += rec->ptr ? 1 : 0;
+                break;
+            }
+            start = nowNs();
+            Allocator_free(allocator, ptr);
+            account(opStats, start, false);
+            break;
+        case AllocatorTrace_Op_REALLOC:
+        {
+            void* old = rec->arg ? AddrMap_take(map, rec->arg) : NULL;
+
+            if (rec->arg && NULL == old)
+            {
+                opStats->skipped++;
+                break;
+            }
+            // the block lives on at the address returned when recorded, or
+            // at the old one if the recorded request failed
+            uintptr_t key = rec->ptr ? rec->ptr : rec->arg;
+
+            start = nowNs();
+            ptr = Allocator_realloc(allocator, old, rec->size);
+            account(opStats, start, NULL == ptr && rec->size);
+            if (NULL == ptr)
+            {
+                // the old block is still valid unless it was freed
+                if (old != NULL && rec->size)
+                {
+                    AddrMap_put(map, key, old);
+                }
+            }
+            else if (!key)
+            {
+                Allocator_free(allocator, ptr);
+            }
+            else
+            {
+                AddrMap_put(map, key, ptr);
+            }
+            break;
+        }
+        default:
+            stats[0].skipped++;
+            break;
+        }
+    }
+}
+
+static bool
+createFirstFit(Target* self, size_t elementSize, size_t numElements)
+{
+    bool retval = BitmapAllocator_ctor(&self->bmAllocator,
+                                       elementSize,
+                                       numElements);
+
+    self->allocator = retval
+                      ? BitmapAllocator_TO_ALLOCATOR(&self->bmAllocator)
+                      : NULL;
+    return retval;
+}
+
+static bool
+createNextFit(Target* self, size_t elementSize, size_t numElements)
+{
+    bool retval = BitmapAllocator_ctorWithPolicy(
+                      &self->bmAllocator,
+                      elementSize,
+                      numElements,
+                      BitmapAllocator_Policy_NEXT_FIT);
+
+    self->allocator = retval
+                      ? BitmapAllocator_TO_ALLOCATOR(&self->bmAllocator)
+                      : NULL;
+    return retval;
+}
+
+static bool
+createSummary(Target* self, size_t elementSize, size_t numElements)
+{
+    bool retval = BitmapAllocator_ctorWithSummary(
+                      &self->bmAllocator,
+                      elementSize,
+                      numElements,
+                      BitmapAllocator_Policy_FIRST_FIT);
+
+    self->allocator = retval
+                      ? BitmapAllocator_TO_ALLOCATOR(&self->bmAllocator)
+                      : NULL;
+    return retval;
+}
+
+// AllocatorSafe over a first-fit BitmapAllocator, to see the cost of the lock
+static bool
+createSafe(Target* self, size_t elementSize, size_t numElements)
+{
+    bool retval = createFirstFit(self, elementSize, numElements);
+
+    if (retval)
+    {
+        self->impl      = self->allocator;
+        self->allocator = NULL;
+        self->mutex     = Mutex_create();
+        retval = (self->mutex != NULL
+                  && AllocatorSafe_ctor(&self->safe, self->impl, self->mutex));
+        self->allocator = retval ? AllocatorSafe_TO_ALLOCATOR(&self->safe) : NULL;
+    }
+    return retval;
+}
+
+static bool
+createTlsf(Target* self, size_t elementSize, size_t numElements)
+{
+    bool retval = false;
+    size_t size = elementSize * numElements;
+
+    if (!numElements || size / numElements != elementSize)
+    {
+        retval = false;
+    }
+    else if ((self->buffer = malloc(size)) != NULL
+             && TlsfAllocator_ctorStatic(&self->tlsf, self->buffer, size))
+    {
+        self->allocator = TlsfAllocator_TO_ALLOCATOR(&self->tlsf);
+        retval = true;
+    }
+    return retval;
+}
+
+// self must be zeroed, the create functions only set the members they have
+// constructed, so destroyTarget() cleans up after a failure too
+static bool
+createTarget(Target* self,
+             size_t elementSize,
+             size_t numElements,
+             const char* name)
+{
+    bool retval = false;
+
+    for (size_t i = 0; i < NUM_TARGETS; i++)
+    {
+        if (!strcmp(name, targets[i].name))
+        {
+            retval = targets[i].ctor(self, elementSize, numElements);
+            break;
+        }
+    }
+    return retval;
+}
+
+static void
+destroyTarget(Target* self)
+{
+    if (self->allocator != NULL)
+    {
+        Allocator_dtor(self->allocator);
+    }
+    if (self->impl != NULL)
+    {
+        Allocator_dtor(self->impl);
+    }
+    if (self->mutex != NULL)
+    {
+        Mutex_destroy(self->mutex);
+    }
+    free(self->buffer);
+}
+
+static void
+usage(const char* prog)
+{
+    fprintf(stderr,
+            "usage: %s <trace file> <elementSize> <numElements> [target]\n"
+            "targets:",
+            prog);
+    for (size_t i = 0; i < NUM_TARGETS; i++)
+    {
+        fprintf(stderr, " %s", targets[i].name);
+    }
+    fprintf(stderr, "\n");
+}
+
+/* Main ----------------------------------------------------------------------*/
+
+int
+main(int argc, char* argv[])
+{
+    if (argc < 4 || argc > 5)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE* file = fopen(argv[1], "rb");
+    if (NULL == file)
+    {
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+    fseek(file, 0, SEEK_END);
+    size_t num = (size_t) ftell(file) / sizeof(AllocatorTrace_Record);
+    fseek(file, 0, SEEK_SET);
+
+    AllocatorTrace_Record* records = calloc(num ? num : 1, sizeof(*records));
+    if (NULL == records || fread(records, sizeof(*records), num, file) != num)
+    {
+        fprintf(stderr, "%s: can not read the trace\n", argv[1]);
+        fclose(file);
+        free(records);
+        return EXIT_FAILURE;
+    }
+    fclose(file);
+
+    size_t mapSize = 16;
+    while (mapSize < 2 * num)
+    {
+        mapSize *= 2;
+    }
+    AddrMap map =
+    {
+        .keys   = calloc(mapSize, sizeof(uintptr_t)),
+        .values = calloc(mapSize, sizeof(void*)),
+        .mask   = mapSize - 1
+    };
+    Target target;
+    memset(&target, 0, sizeof(target));
+
+    if (NULL == map.keys
+        || NULL == map.values
+        || !createTarget(&target,
+                         strtoul(argv[2], NULL, 0),
+                         strtoul(argv[3], NULL, 0),
+                         (5 == argc) ? argv[4] : "first-fit"))
+    {
+        fprintf(stderr, "can not create the allocator\n");
+        usage(argv[0]);
+        destroyTarget(&target);
+        free(records);
+        free(map.keys);
+        free(map.values);
+        return EXIT_FAILURE;
+    }
+
+    OpStats stats[NUM_OPS];
+    memset(stats, 0, sizeof(stats));
+
+    replay(target.allocator, records, num, &map, stats);
+
+    printf("%zu records\n", num);
+    printf("%-14s %10s %10s %10s %12s %12s\n",
+           "op", "count", "failed", "skipped", "mean ns", "max ns");
+    for (size_t op = AllocatorTrace_Op_ALLOC; op < NUM_OPS; op++)
+    {
+        printf("%-14s %10zu %10zu %10zu %12.1f %12llu\n",
+               opNames[op],
+               stats[op].count,
+               stats[op].failed,
+               stats[op].skipped,
+               stats[op].count
+               ? (double) stats[op].totalNs / stats[op].count : 0.0,
+               (unsigned long long) stats[op].maxNs);
+    }
+    if (stats[0].skipped)
+    {
+        printf("%zu records with an unknown op\n", stats[0].skipped);
+    }
+
+    destroyTarget(&target);
+    free(records);
+    free(map.keys);
+    free(map.values);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+#include "lib_mem/AllocatorTrace.h"
+#include "lib_mem/BitmapAllocator.h"
+#include <stdint.h>
+}
+
+constexpr size_t kElementSize   = 16;
+constexpr size_t kNumElements   = 64;
+constexpr size_t kRingCapacity  = 8;
+
+static uint64_t
+Test_AllocatorTrace_clock(void)
+{
+    static uint64_t now = 0;
+    return ++now;
+}
+
+class Test_AllocatorTrace : public testing::Test
+{
+    protected:
+        BitmapAllocator bmAllocator;
+        AllocatorTrace tracer;
+        AllocatorTrace_Ring ring;
+        AllocatorTrace_Record records[kRingCapacity];
+        Allocator* allocator = AllocatorTrace_TO_ALLOCATOR(&tracer);
+
+        void SetUp()
+        {
+            ASSERT_TRUE(BitmapAllocator_ctor(&bmAllocator,
+                                             kElementSize,
+                                             kNumElements));
+            ASSERT_TRUE(AllocatorTrace_Ring_ctor(&ring,
+                                                 records,
+                                                 kRingCapacity));
+            ASSERT_TRUE(AllocatorTrace_ctor(
+                            &tracer,
+                            BitmapAllocator_TO_ALLOCATOR(&bmAllocator),
+                            &ring,
+                            Test_AllocatorTrace_clock));
+        }
+
+        void TearDown()
+        {
+            BitmapAllocator_dtor(BitmapAllocator_TO_ALLOCATOR(&bmAllocator));
+        }
+};
+
+/*----------------------------------------------------------------------------*/
+TEST(Test_AllocatorTrace_Ring, ctor_neg)
+{
+    AllocatorTrace_Ring ring;
+    AllocatorTrace_Record records[3];
+
+    ASSERT_FALSE(AllocatorTrace_Ring_ctor(&ring, records, 3));
+    ASSERT_FALSE(AllocatorTrace_Ring_ctor(&ring, records, 0));
+    ASSERT_FALSE(AllocatorTrace_Ring_ctor(&ring, NULL, 2));
+}
+
+// Every request is forwarded and recorded in order
+TEST_F(Test_AllocatorTrace, record_requests_pos)
+{
+    AllocatorTrace_Record out[kRingCapacity];
+    size_t next = 0;
+
+    void* block = Allocator_alloc(allocator, kElementSize);
+    ASSERT_NE(block, nullptr);
+    void* moved = Allocator_realloc(allocator, block, kElementSize * 2);
+    ASSERT_EQ(moved, block);
+    ASSERT_EQ(Allocator_usableSize(allocator, moved), kElementSize * 2);
+    ASSERT_EQ(Allocator_alloc(allocator, kElementSize * (kNumElements + 1)),
+              nullptr);
+    Allocator_free(allocator, moved);
+    ASSERT_EQ(bmAllocator.allocatedElements, 0);
+
+    ASSERT_EQ(AllocatorTrace_Ring_read(&ring, &next, out, kRingCapacity), 4);
+    ASSERT_EQ(next, 4);
+
+    ASSERT_EQ(out[0].op, AllocatorTrace_Op_ALLOC);
+    ASSERT_EQ(out[0].ptr, (uintptr_t) block);
+    ASSERT_EQ(out[0].size, kElementSize);
+    ASSERT_EQ(out[1].op, AllocatorTrace_Op_REALLOC);
+    ASSERT_EQ(out[1].ptr, (uintptr_t) moved);
+    ASSERT_EQ(out[1].arg, (uintptr_t) block);
+    ASSERT_EQ(out[2].op, AllocatorTrace_Op_ALLOC);
+    ASSERT_EQ(out[2].ptr, 0);
+    ASSERT_EQ(out[3].op, AllocatorTrace_Op_FREE);
+    ASSERT_EQ(out[3].ptr, (uintptr_t) moved);
+    for (size_t i = 0; i < 4; i++)
+    {
+        ASSERT_EQ(out[i].seq, i + 1);
+        ASSERT_LT(i ? out[i - 1].timestamp : 0, out[i].timestamp);
+    }
+
+    // Nothing new
+    ASSERT_EQ(AllocatorTrace_Ring_read(&ring, &next, out, kRingCapacity), 0);
+}
+
+// The oldest records are overwritten when the reader falls behind
+TEST_F(Test_AllocatorTrace, overwrite_oldest_pos)
+{
+    AllocatorTrace_Record out[kRingCapacity];
+    size_t next = 0;
+
+    for (size_t i = 0; i < kRingCapacity + 3; i++)
+    {
+        Allocator_free(allocator, Allocator_alloc(allocator, kElementSize));
+    }
+    ASSERT_EQ(AllocatorTrace_Ring_read(&ring, &next, out, kRingCapacity),
+              kRingCapacity);
+    ASSERT_EQ(out[0].seq, 2 * (kRingCapacity + 3) - kRingCapacity + 1);
+    ASSERT_EQ(next, 2 * (kRingCapacity + 3));
+}
+
+// Concurrent writers never lose a record as long as the reader keeps up
+TEST(Test_AllocatorTrace_Ring, concurrent_writers_pos)
+{
+    constexpr size_t kThreads = 4;
+    constexpr size_t kPerThread = 10000;
+    constexpr size_t kCapacity = 1 << 16;
+
+    BitmapAllocator bmAllocator;
+    AllocatorTrace tracer;
+    AllocatorTrace_Ring ring;
+    std::vector<AllocatorTrace_Record> records(kCapacity);
+    std::vector<AllocatorTrace_Record> out(kCapacity);
+    std::vector<std::thread> threads;
+    size_t next = 0;
+    size_t count = 0;
+
+    ASSERT_TRUE(BitmapAllocator_ctor(&bmAllocator, kElementSize, kNumElements));
+    ASSERT_TRUE(AllocatorTrace_Ring_ctor(&ring, records.data(), kCapacity));
+    ASSERT_TRUE(AllocatorTrace_ctor(&tracer,
+                                    BitmapAllocator_TO_ALLOCATOR(&bmAllocator),
+                                    &ring,
+                                    NULL));
+
+    for (size_t t = 0; t < kThreads; t++)
+    {
+        threads.emplace_back([&tracer]()
+        {
+            for (size_t i = 0; i < kPerThread; i++)
+            {
+                // freeing NULL does not touch the pool, only the ring
+                AllocatorTrace_free(AllocatorTrace_TO_ALLOCATOR(&tracer),
+                                    (void*) 0);
+            }
+        });
+    }
+    while (count < kThreads * kPerThread)
+    {
+        size_t read = AllocatorTrace_Ring_read(&ring,
+                                               &next,
+                                               &out[count],
+                                               kCapacity - count);
+        for (size_t i = count; i < count + read; i++)
+        {
+            ASSERT_EQ(out[i].seq, i + 1);
+            ASSERT_EQ(out[i].op, AllocatorTrace_Op_FREE);
+        }
+        count += read;
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    ASSERT_EQ(count, kThreads * kPerThread);
+
+    BitmapAllocator_dtor(BitmapAllocator_TO_ALLOCATOR(&bmAllocator));
+}
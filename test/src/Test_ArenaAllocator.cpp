@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <gtest/gtest.h>
+
+#include <stddef.h>
+
+extern "C"
+{
+#include "lib_mem/ArenaAllocator.h"
+#include "lib_mem/BitmapAllocator.h"
+#include <stdint.h>
+}
+
+constexpr size_t kArenaSize = 256;
+constexpr size_t kAlignment = alignof(max_align_t);
+
+/*----------------------------------------------------------------------------*/
+TEST(Test_ArenaAllocator_ctor, invalid_args_neg)
+{
+    static uint8_t buffer[kArenaSize];
+    ArenaAllocator arena;
+
+    ASSERT_FALSE(ArenaAllocator_ctorStatic(&arena, NULL, kArenaSize, NULL));
+    ASSERT_FALSE(ArenaAllocator_ctorStatic(&arena, buffer, 0, NULL));
+}
+
+// Blocks are bumped aligned out of the buffer behind their size, a release
+// gives back what was allocated after the mark and a reset everything
+TEST(Test_ArenaAllocator, mark_release_reset_pos)
+{
+    ArenaAllocator arena;
+    Allocator* allocator = ArenaAllocator_TO_ALLOCATOR(&arena);
+
+    ASSERT_TRUE(ArenaAllocator_ctor(&arena, kArenaSize, NULL));
+
+    uint8_t* first = (uint8_t*) Allocator_alloc(allocator, 1);
+    ASSERT_EQ(first, arena.buffer + kAlignment);
+    uint8_t* second = (uint8_t*) Allocator_alloc(allocator, 1);
+    ASSERT_EQ(second, first + kAlignment);
+    uint8_t* aligned = (uint8_t*) Allocator_allocAligned(allocator, 3, 64);
+    ASSERT_NE(aligned, nullptr);
+    ASSERT_EQ((uintptr_t) aligned % 64, 0);
+    ASSERT_EQ(Allocator_alloc(allocator, 0), nullptr);
+
+    Allocator_free(allocator, second);
+    ArenaAllocator_Mark mark = ArenaAllocator_mark(&arena);
+    uint8_t* afterMark = (uint8_t*) Allocator_alloc(allocator, 100);
+    ASSERT_NE(afterMark, nullptr);
+    ASSERT_EQ(Allocator_alloc(allocator, kArenaSize), nullptr);
+
+    ArenaAllocator_release(&arena, mark);
+    ASSERT_EQ(Allocator_alloc(allocator, 100), afterMark);
+
+    ArenaAllocator_reset(&arena);
+    ASSERT_EQ(Allocator_alloc(allocator, kArenaSize - kAlignment), first);
+
+    Allocator_dtor(allocator);
+}
+
+// With a chunk allocator the arena grows, releases give the chunks back
+TEST(Test_ArenaAllocator, grow_by_chunks_pos)
+{
+    alignas(max_align_t) static uint8_t buffer[kArenaSize];
+    BitmapAllocator bmAllocator;
+    ArenaAllocator arena;
+    Allocator* allocator = ArenaAllocator_TO_ALLOCATOR(&arena);
+
+    ASSERT_TRUE(BitmapAllocator_ctor(&bmAllocator, kAlignment, 1024));
+    ASSERT_TRUE(ArenaAllocator_ctorStatic(
+                    &arena,
+                    buffer,
+                    sizeof(buffer),
+                    BitmapAllocator_TO_ALLOCATOR(&bmAllocator)));
+
+    void* inBuffer = Allocator_alloc(allocator, kArenaSize - kAlignment);
+    ASSERT_EQ(inBuffer, buffer + kAlignment);
+    ArenaAllocator_Mark mark = ArenaAllocator_mark(&arena);
+
+    // a chunk of the arena size, then one for a request larger than that
+    uint8_t* small = (uint8_t*) Allocator_alloc(allocator, 10);
+    ASSERT_NE(small, nullptr);
+    ASSERT_TRUE(small < buffer || small >= buffer + sizeof(buffer));
+    uint8_t* large = (uint8_t*) Allocator_alloc(allocator, 4 * kArenaSize);
+    ASSERT_NE(large, nullptr);
+    memset(large, 0, 4 * kArenaSize);
+    ASSERT_GT(bmAllocator.allocatedElements, 0);
+
+    ArenaAllocator_release(&arena, mark);
+    ASSERT_EQ(bmAllocator.allocatedElements, 0);
+    ASSERT_EQ(Allocator_alloc(allocator, 10), small);
+
+    Allocator_dtor(allocator);
+    ASSERT_EQ(bmAllocator.allocatedElements, 0);
+    BitmapAllocator_dtor(BitmapAllocator_TO_ALLOCATOR(&bmAllocator));
+}
+
+// The most recent block is resized in place, the others move when they grow
+TEST(Test_ArenaAllocator, realloc_pos)
+{
+    alignas(max_align_t) static uint8_t buffer[kArenaSize];
+    ArenaAllocator arena;
+    Allocator* allocator = ArenaAllocator_TO_ALLOCATOR(&arena);
+
+    ASSERT_TRUE(ArenaAllocator_ctorStatic(&arena, buffer, sizeof(buffer),
+                                          NULL));
+
+    uint8_t* lower = (uint8_t*) Allocator_alloc(allocator, 16);
+    memset(lower, 0xA5, 16);
+    uint8_t* top = (uint8_t*) Allocator_alloc(allocator, 16);
+    memset(top, 0x5A, 16);
+
+    ASSERT_EQ(Allocator_realloc(allocator, top, 64), top);
+    ASSERT_EQ(Allocator_usableSize(allocator, top), 64);
+    ASSERT_EQ(arena.top, top + 64);
+    ASSERT_EQ(Allocator_realloc(allocator, top, 8), top);
+    ASSERT_EQ(arena.top, top + 8);
+    ASSERT_EQ(Allocator_realloc(allocator, lower, 4), lower);
+    ASSERT_EQ(Allocator_usableSize(allocator, lower), 4);
+
+    // growing a lower block copies the size it had
+    uint8_t* moved = (uint8_t*) Allocator_realloc(allocator, lower, 100);
+    ASSERT_NE(moved, nullptr);
+    ASSERT_GT(moved, top);
+    for (size_t i = 0; i < 4; i++)
+    {
+        ASSERT_EQ(moved[i], 0xA5);
+    }
+    ASSERT_EQ(top[0], 0x5A);
+
+    // no room left, the block stays as it was
+    ASSERT_EQ(Allocator_realloc(allocator, top, kArenaSize), nullptr);
+    ASSERT_EQ(Allocator_usableSize(allocator, top), 8);
+
+    Allocator_dtor(allocator);
+}
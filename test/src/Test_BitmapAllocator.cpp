@@ -8,9 +8,13 @@
 
 #include <gtest/gtest.h>
 
+#include <random>
+#include <vector>
+
 extern "C"
 {
 #include "lib_mem/BitmapAllocator.h"
+#include "lib_mem/BitmapAllocator_Static.h"
 #include <stdint.h>
 #include <limits.h>
 }
@@ -24,6 +28,8 @@ constexpr unsigned kElementSize = sizeof(uint64_t);
 
 constexpr unsigned kAllocatorBufSize = (kNumMemoryElements* kElementSize);
 
+BitmapAllocator_DEFINE_STATIC(Test_pool, kElementSize, kNumMemoryElements)
+
 /*----------------------------------------------------------------------------*/
 static void
 Test_BitmapAllocator_allocateFullMemory(BitmapAllocator* bmAllocator,
@@ -228,6 +234,527 @@ TEST_F(Test_BitmapAllocator_fullMemorySetUp,
     ASSERT_EQ(reallocatedAddr, nullptr);
 }
 
+// Verify that a failed scan tightens the bound of the longest free run and
+// that freeing the neighbouring element makes the larger request succeed.
+TEST_F(Test_BitmapAllocator_fullMemorySetUp,
+       free_run_bound_after_failed_alloc_pos)
+{
+    void* addr = &((uint64_t*) baseAddr)[kNumMemoryElements / 2];
+    BitmapAllocator_free(BitmapAllocator_TO_ALLOCATOR(&bmAllocator), addr);
+
+    ASSERT_EQ(BitmapAllocator_alloc(BitmapAllocator_TO_ALLOCATOR(&bmAllocator),
+                                    kElementSize * 2), nullptr);
+    ASSERT_EQ(bmAllocator.maxFreeRun, 1);
+
+    BitmapAllocator_free(BitmapAllocator_TO_ALLOCATOR(&bmAllocator),
+                         &((uint64_t*) addr)[1]);
+    ASSERT_EQ(BitmapAllocator_alloc(BitmapAllocator_TO_ALLOCATOR(&bmAllocator),
+                                    kElementSize * 2), addr);
+}
+
+// Allocate a batch of single elements, verify it matches the first-fit order,
+// that it stops when the memory is full and that a batch free releases it.
+TEST_F(Test_BitmapAllocator, allocate_and_free_batch_pos)
+{
+    void* ptrs[kNumMemoryElements + 1];
+
+    ASSERT_EQ(Allocator_allocBatch(BitmapAllocator_TO_ALLOCATOR(&bmAllocator),
+                                   kElementSize,
+                                   ptrs,
+                                   kNumMemoryElements + 1),
+              kNumMemoryElements);
+    for (unsigned i = 0; i < kNumMemoryElements; i++)
+    {
+        ASSERT_EQ(ptrs[i], &((uint64_t*) ptrs[0])[i]);
+    }
+
+    // Free every other element, a batch of pairs can not be satisfied
+    void* odd[kNumMemoryElements / 2];
+    for (unsigned i = 0; i < kNumMemoryElements / 2; i++)
+    {
+        odd[i] = ptrs[2 * i + 1];
+    }
+    Allocator_freeBatch(BitmapAllocator_TO_ALLOCATOR(&bmAllocator),
+                        odd,
+                        kNumMemoryElements / 2);
+    ASSERT_EQ(bmAllocator.allocatedElements, kNumMemoryElements -
+              kNumMemoryElements / 2);
+    ASSERT_EQ(Allocator_allocBatch(BitmapAllocator_TO_ALLOCATOR(&bmAllocator),
+                                   kElementSize * 2,
+                                   ptrs,
+                                   1),
+              0);
+}
+
+// Grow a block into the free elements behind it, shrink it again and verify
+// that it only moves, keeping its content, when its neighbour is busy.
+TEST_F(Test_BitmapAllocator, realloc_in_place_and_move_pos)
+{
+    Allocator* allocator = BitmapAllocator_TO_ALLOCATOR(&bmAllocator);
+
+    uint64_t* block = (uint64_t*) Allocator_alloc(allocator, kElementSize * 2);
+    ASSERT_NE(block, nullptr);
+    ASSERT_EQ(Allocator_usableSize(allocator, block), kElementSize * 2);
+    block[0] = 0xA5A5;
+    block[1] = 0x5A5A;
+
+    // Grow in place
+    ASSERT_EQ(Allocator_realloc(allocator, block, kElementSize * 4), block);
+    ASSERT_EQ(Allocator_usableSize(allocator, block), kElementSize * 4);
+    ASSERT_EQ(bmAllocator.allocatedElements, 4);
+
+    // Shrink in place, the released tail can be allocated again
+    ASSERT_EQ(Allocator_realloc(allocator, block, kElementSize + 1), block);
+    ASSERT_EQ(Allocator_usableSize(allocator, block), kElementSize * 2);
+    void* neighbour = Allocator_alloc(allocator, kElementSize);
+    ASSERT_EQ(neighbour, &block[2]);
+
+    // Growing now needs to move the block
+    uint64_t* moved = (uint64_t*) Allocator_realloc(allocator,
+                                                    block,
+                                                    kElementSize * 3);
+    ASSERT_NE(moved, nullptr);
+    ASSERT_NE(moved, block);
+    ASSERT_EQ(moved[0], 0xA5A5);
+    ASSERT_EQ(moved[1], 0x5A5A);
+    ASSERT_EQ(bmAllocator.allocatedElements, 4);
+    ASSERT_EQ(Allocator_usableSize(allocator, block), 0);
+}
+
+// Without an own realloc the generic path copies the smaller size, and
+// without a usableSize it can not know that size and fails, leaving the block
+// untouched.
+TEST_F(Test_BitmapAllocator, realloc_generic_path_pos)
+{
+    Allocator* allocator = BitmapAllocator_TO_ALLOCATOR(&bmAllocator);
+    const Allocator_Vtable* vtable = bmAllocator.parent.vtable;
+    Allocator_Vtable withSize = {};
+    withSize.alloc      = vtable->alloc;
+    withSize.free       = vtable->free;
+    withSize.dtor       = vtable->dtor;
+    withSize.usableSize = vtable->usableSize;
+    Allocator_Vtable withoutSize = withSize;
+    withoutSize.usableSize = NULL;
+
+    uint64_t* block = (uint64_t*) Allocator_alloc(allocator, kElementSize * 2);
+    ASSERT_NE(block, nullptr);
+    block[0] = 0xA5A5;
+    block[1] = 0x5A5A;
+
+    bmAllocator.parent.vtable = &withoutSize;
+    ASSERT_EQ(Allocator_realloc(allocator, block, kElementSize * 8), nullptr);
+    ASSERT_EQ(bmAllocator.allocatedElements, 2);
+
+    bmAllocator.parent.vtable = &withSize;
+    uint64_t* moved = (uint64_t*) Allocator_realloc(allocator,
+                                                    block,
+                                                    kElementSize * 8);
+    bmAllocator.parent.vtable = vtable;
+
+    ASSERT_NE(moved, nullptr);
+    ASSERT_EQ(moved[0], 0xA5A5);
+    ASSERT_EQ(moved[1], 0x5A5A);
+    ASSERT_EQ(bmAllocator.allocatedElements, 8);
+    Allocator_free(allocator, moved);
+}
+
+// Verify the counters after a few successful and failed requests.
+TEST_F(Test_BitmapAllocator, collect_stats_pos)
+{
+    Allocator* allocator = BitmapAllocator_TO_ALLOCATOR(&bmAllocator);
+    BitmapAllocator_Stats stats;
+
+    void* first = Allocator_alloc(allocator, kElementSize + 1);
+    void* second = Allocator_alloc(allocator, kElementSize);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    ASSERT_EQ(Allocator_alloc(allocator, kAllocatorBufSize), nullptr);
+    Allocator_free(allocator, first);
+    Allocator_free(allocator, second);
+
+    ASSERT_TRUE(BitmapAllocator_getStats(&bmAllocator, &stats));
+    ASSERT_EQ(stats.allocCount, 2);
+    ASSERT_EQ(stats.freeCount, 2);
+    ASSERT_EQ(stats.failedAllocCount, 1);
+    ASSERT_EQ(stats.highWaterMark, 3);
+    ASSERT_EQ(stats.requestedBytes, 2 * kElementSize + 1);
+    ASSERT_EQ(stats.consumedElements, 3);
+    ASSERT_GE(stats.scannedWords, 2);
+    ASSERT_GE(stats.maxScannedWords, 1);
+    ASSERT_LE(stats.maxScannedWords, stats.scannedWords);
+}
+
+// Allocate aligned blocks from a pool whose buffer and element size do not
+// match the alignment and verify that only aligned elements are handed out.
+TEST(Test_BitmapAllocator_aligned, allocate_aligned_pos)
+{
+    constexpr size_t kOddElementSize  = 24;
+    constexpr size_t kNumElements     = 100;
+    constexpr size_t kAlignment       = 64;
+    // every 8th element is aligned, starting with the 5th
+    constexpr size_t kFirstAligned    = 5;
+    constexpr size_t kStride          = 8;
+
+    alignas(kAlignment) static uint8_t buffer[kNumElements * kOddElementSize
+                                              + sizeof(uint64_t)];
+    static BitmapAllocator_BitmapSlot bitmap[
+        BitmapAllocator_BITMAP_SIZE(kNumElements)
+        / sizeof(BitmapAllocator_BitmapSlot)];
+    static BitmapAllocator_BitmapSlot boundaryBitmap[
+        BitmapAllocator_BITMAP_SIZE(kNumElements)
+        / sizeof(BitmapAllocator_BitmapSlot)];
+
+    BitmapAllocator bmAllocator;
+    Allocator* allocator = BitmapAllocator_TO_ALLOCATOR(&bmAllocator);
+    uint8_t* base = &buffer[sizeof(uint64_t)];
+
+    ASSERT_TRUE(BitmapAllocator_ctorStatic(&bmAllocator,
+                                           base,
+                                           bitmap,
+                                           boundaryBitmap,
+                                           kOddElementSize,
+                                           kNumElements));
+
+    // Occupy the first aligned element, so that the search has to skip it
+    ASSERT_EQ(BitmapAllocator_alloc(allocator,
+                                    kOddElementSize * (kFirstAligned + 1)),
+              base);
+
+    void* addr = Allocator_allocAligned(allocator, 30, kAlignment);
+    ASSERT_EQ(addr, base + (kFirstAligned + kStride) * kOddElementSize);
+    ASSERT_EQ((uintptr_t) addr % kAlignment, 0);
+
+    addr = Allocator_allocAligned(allocator, 30, kAlignment);
+    ASSERT_EQ(addr, base + (kFirstAligned + 2 * kStride) * kOddElementSize);
+
+    // The elements in between are still available for unaligned requests
+    ASSERT_EQ(BitmapAllocator_alloc(allocator, kOddElementSize),
+              base + (kFirstAligned + 1) * kOddElementSize);
+}
+
+// Free runs of 1, 2, 8 and 1 elements in a full pool and verify the report.
+TEST_F(Test_BitmapAllocator_fullMemorySetUp, report_fragmentation_pos)
+{
+    Allocator* allocator = BitmapAllocator_TO_ALLOCATOR(&bmAllocator);
+    uint64_t* base = (uint64_t*) baseAddr;
+    BitmapAllocator_Fragmentation report;
+
+    BitmapAllocator_getFragmentation(&bmAllocator, &report);
+    ASSERT_EQ(report.numFreeRuns, 0);
+    ASSERT_EQ(report.fragmentation, 0);
+    ASSERT_EQ(report.liveAllocations, kNumMemoryElements);
+
+    Allocator_free(allocator, &base[0]);
+    Allocator_free(allocator, &base[2]);
+    Allocator_free(allocator, &base[3]);
+    for (unsigned i = 5; i < 13; i++)
+    {
+        Allocator_free(allocator, &base[i]);
+    }
+    Allocator_free(allocator, &base[kNumMemoryElements - 1]);
+
+    BitmapAllocator_getFragmentation(&bmAllocator, &report);
+    ASSERT_EQ(report.numFreeRuns, 4);
+    ASSERT_EQ(report.freeRuns[0], 2);
+    ASSERT_EQ(report.freeRuns[1], 1);
+    ASSERT_EQ(report.freeRuns[2], 0);
+    ASSERT_EQ(report.freeRuns[3], 1);
+    ASSERT_EQ(report.freeElements, 12);
+    ASSERT_EQ(report.largestFreeRun, 8);
+    ASSERT_EQ(report.fragmentation, 1000 - 1000 * 8 / 12);
+    ASSERT_EQ(report.liveAllocations, kNumMemoryElements - 12);
+
+    // The report tightened the bound, larger requests fail without a scan
+    ASSERT_EQ(bmAllocator.maxFreeRun, 8);
+    ASSERT_EQ(Allocator_alloc(allocator, kElementSize * 9), nullptr);
+    ASSERT_EQ(Allocator_alloc(allocator, kElementSize * 8), &base[5]);
+}
+
+// Free a gap straddling the border of two bitmap slots and verify that the
+// word based search finds it as one contiguous run.
+TEST_F(Test_BitmapAllocator_fullMemorySetUp,
+       free_space_across_slots_and_reallocate_pos)
+{
+    constexpr unsigned kBitsInSlot = sizeof(BitmapAllocator_BitmapSlot) *
+                                     CHAR_BIT;
+    constexpr unsigned kGapStart   = kBitsInSlot - 2;
+    constexpr unsigned kGapSize    = 5;
+
+    for (unsigned i = kGapStart; i < kGapStart + kGapSize; i++)
+    {
+        BitmapAllocator_free(BitmapAllocator_TO_ALLOCATOR(&bmAllocator),
+                             &((uint64_t*) baseAddr)[i]);
+    }
+
+    void* addr = BitmapAllocator_alloc(BitmapAllocator_TO_ALLOCATOR(&bmAllocator),
+                                       kElementSize * kGapSize);
+    ASSERT_EQ(addr, &((uint64_t*) baseAddr)[kGapStart]);
+}
+
+// Free very large blocks and verify that exactly their elements are released.
+TEST(Test_BitmapAllocator_largePool, free_large_blocks_pos)
+{
+    constexpr size_t kLargeNumElements = 64 * 1024 + 3;
+    constexpr size_t kFirstBlock       = 20000;
+    constexpr size_t kSecondBlock      = 30001;
+    constexpr size_t kThirdBlock       = kLargeNumElements - kFirstBlock
+                                         - kSecondBlock;
+    BitmapAllocator bmAllocator;
+    Allocator* allocator = BitmapAllocator_TO_ALLOCATOR(&bmAllocator);
+
+    ASSERT_TRUE(BitmapAllocator_ctor(&bmAllocator,
+                                     kElementSize,
+                                     kLargeNumElements));
+
+    void* first  = BitmapAllocator_alloc(allocator, kFirstBlock * kElementSize);
+    void* second = BitmapAllocator_alloc(allocator, kSecondBlock * kElementSize);
+    void* third  = BitmapAllocator_alloc(allocator, kThirdBlock * kElementSize);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    ASSERT_NE(third, nullptr);
+    ASSERT_EQ(bmAllocator.allocatedElements, kLargeNumElements);
+
+    // Free the block in the middle, its neighbours must stay allocated
+    BitmapAllocator_free(allocator, second);
+    ASSERT_EQ(bmAllocator.allocatedElements, kFirstBlock + kThirdBlock);
+    ASSERT_EQ(BitmapAllocator_alloc(allocator,
+                                    (kSecondBlock + 1) * kElementSize),
+              nullptr);
+    ASSERT_EQ(BitmapAllocator_alloc(allocator, kSecondBlock * kElementSize),
+              second);
+
+    BitmapAllocator_free(allocator, first);
+    BitmapAllocator_free(allocator, second);
+    BitmapAllocator_free(allocator, third);
+    ASSERT_EQ(bmAllocator.allocatedElements, 0);
+
+    void* addr = BitmapAllocator_alloc(allocator,
+                                       kLargeNumElements * kElementSize);
+    ASSERT_EQ(addr, first);
+
+    BitmapAllocator_dtor(allocator);
+}
+
+// Verify that the next-fit policy continues after the previous allocation and
+// only reuses freed space at the start of the pool after wrapping around.
+TEST(Test_BitmapAllocator_nextFit, allocate_after_cursor_and_wrap_pos)
+{
+    BitmapAllocator bmAllocator;
+    Allocator* allocator = BitmapAllocator_TO_ALLOCATOR(&bmAllocator);
+
+    ASSERT_TRUE(BitmapAllocator_ctorWithPolicy(&bmAllocator,
+                                               kElementSize,
+                                               kNumMemoryElements,
+                                               BitmapAllocator_Policy_NEXT_FIT));
+
+    void* first  = BitmapAllocator_alloc(allocator, kElementSize);
+    void* second = BitmapAllocator_alloc(allocator, kElementSize);
+    ASSERT_EQ(second, &((uint64_t*) first)[1]);
+
+    // The freed first element is skipped while there is space behind the
+    // cursor
+    BitmapAllocator_free(allocator, first);
+    void* third = BitmapAllocator_alloc(allocator, kElementSize);
+    ASSERT_EQ(third, &((uint64_t*) first)[2]);
+
+    // Fill up the rest of the pool, the next request wraps around
+    void* rest = BitmapAllocator_alloc(allocator,
+                                       (kNumMemoryElements - 3) * kElementSize);
+    ASSERT_EQ(rest, &((uint64_t*) first)[3]);
+    ASSERT_EQ(BitmapAllocator_alloc(allocator, kElementSize), first);
+    ASSERT_EQ(BitmapAllocator_alloc(allocator, kElementSize), nullptr);
+
+    BitmapAllocator_dtor(allocator);
+}
+
+// Verify that a pool using a caller provided summary bitmap skips the fully
+// busy slots but still finds the free space left behind them.
+TEST(Test_BitmapAllocator_summary, allocate_behind_busy_slots_pos)
+{
+    constexpr size_t kBitsInSlot       = sizeof(BitmapAllocator_BitmapSlot) *
+                                         CHAR_BIT;
+    constexpr size_t kLargeNumElements = kBitsInSlot * kBitsInSlot * 2 + 3;
+
+    static uint64_t buffer[kLargeNumElements];
+    static BitmapAllocator_BitmapSlot bitmap[
+        BitmapAllocator_BITMAP_SIZE(kLargeNumElements)
+        / sizeof(BitmapAllocator_BitmapSlot)];
+    static BitmapAllocator_BitmapSlot boundaryBitmap[
+        BitmapAllocator_BITMAP_SIZE(kLargeNumElements)
+        / sizeof(BitmapAllocator_BitmapSlot)];
+    static BitmapAllocator_BitmapSlot summaryBitmap[
+        BitmapAllocator_SUMMARY_SIZE(kLargeNumElements)
+        / sizeof(BitmapAllocator_BitmapSlot)];
+
+    BitmapAllocator bmAllocator;
+    Allocator* allocator = BitmapAllocator_TO_ALLOCATOR(&bmAllocator);
+
+    ASSERT_TRUE(BitmapAllocator_ctorStaticWithSummary(
+                    &bmAllocator,
+                    buffer,
+                    bitmap,
+                    boundaryBitmap,
+                    summaryBitmap,
+                    kElementSize,
+                    kLargeNumElements,
+                    BitmapAllocator_Policy_FIRST_FIT));
+
+    for (size_t i = 0; i < kLargeNumElements; i++)
+    {
+        ASSERT_EQ(BitmapAllocator_alloc(allocator, kElementSize), &buffer[i]);
+    }
+    ASSERT_EQ(BitmapAllocator_alloc(allocator, kElementSize), nullptr);
+
+    // Free two neighbouring elements close to the end of the pool
+    BitmapAllocator_free(allocator, &buffer[kLargeNumElements - 4]);
+    BitmapAllocator_free(allocator, &buffer[kLargeNumElements - 5]);
+
+    ASSERT_EQ(BitmapAllocator_alloc(allocator, kElementSize * 3), nullptr);
+    ASSERT_EQ(BitmapAllocator_alloc(allocator, kElementSize * 2),
+              &buffer[kLargeNumElements - 5]);
+
+    // A pool constructed from static storage does not release it
+    BitmapAllocator_dtor(allocator);
+}
+
+// Run the same random workload on a pool using the scalar scan kernel and on
+// pools using each vector kernel supported by the CPU, and verify that every
+// allocation returns the same element.
+TEST(Test_BitmapAllocator_kernels, vector_kernels_match_scalar_pos)
+{
+    constexpr size_t kLargeNumElements = 256 * 1024 + 7;
+    constexpr unsigned kIterations     = 20000;
+    const BitmapAllocator_Kernel kernels[] =
+    {
+        BitmapAllocator_Kernel_SSE2,
+        BitmapAllocator_Kernel_AVX2
+    };
+
+    for (BitmapAllocator_Kernel kernel : kernels)
+    {
+        BitmapAllocator scalar;
+        BitmapAllocator vector;
+
+        ASSERT_TRUE(BitmapAllocator_ctor(&scalar,
+                                         kElementSize,
+                                         kLargeNumElements));
+        ASSERT_TRUE(BitmapAllocator_ctor(&vector,
+                                         kElementSize,
+                                         kLargeNumElements));
+        ASSERT_TRUE(BitmapAllocator_setKernel(&scalar,
+                                              BitmapAllocator_Kernel_SCALAR));
+        if (!BitmapAllocator_setKernel(&vector, kernel))
+        {
+            // not supported by this CPU
+            BitmapAllocator_dtor(BitmapAllocator_TO_ALLOCATOR(&scalar));
+            BitmapAllocator_dtor(BitmapAllocator_TO_ALLOCATOR(&vector));
+            continue;
+        }
+
+        std::mt19937 rng(kernel);
+        std::vector<size_t> live;
+
+        for (unsigned i = 0; i < kIterations; i++)
+        {
+            // mostly allocate, so that the pool gets crowded
+            if (!live.empty() && rng() % 4 == 0)
+            {
+                size_t pos = rng() % live.size();
+                size_t elementNum = live[pos];
+                live[pos] = live.back();
+                live.pop_back();
+
+                BitmapAllocator_free(
+                    BitmapAllocator_TO_ALLOCATOR(&scalar),
+                    &((uint64_t*) scalar.baseAddr)[elementNum]);
+                BitmapAllocator_free(
+                    BitmapAllocator_TO_ALLOCATOR(&vector),
+                    &((uint64_t*) vector.baseAddr)[elementNum]);
+            }
+            else
+            {
+                size_t size = kElementSize * (1 + rng() % 64);
+                void* scalarAddr = BitmapAllocator_alloc(
+                                       BitmapAllocator_TO_ALLOCATOR(&scalar),
+                                       size);
+                void* vectorAddr = BitmapAllocator_alloc(
+                                       BitmapAllocator_TO_ALLOCATOR(&vector),
+                                       size);
+                if (NULL == scalarAddr)
+                {
+                    ASSERT_EQ(vectorAddr, nullptr);
+                }
+                else
+                {
+                    size_t elementNum = (uint64_t*) scalarAddr
+                                        - (uint64_t*) scalar.baseAddr;
+                    ASSERT_EQ(vectorAddr,
+                              &((uint64_t*) vector.baseAddr)[elementNum]);
+                    live.push_back(elementNum);
+                }
+            }
+        }
+        BitmapAllocator_dtor(BitmapAllocator_TO_ALLOCATOR(&scalar));
+        BitmapAllocator_dtor(BitmapAllocator_TO_ALLOCATOR(&vector));
+    }
+}
+
+// The compile-time specialized pool has to hand out the same elements as the
+// first-fit BitmapAllocator of the same geometry
+TEST(Test_BitmapAllocator_static, matches_first_fit_pos)
+{
+    static char buf[kAllocatorBufSize];
+    BitmapAllocator reference;
+    std::vector<size_t> live;
+    std::mt19937 rng(11);
+
+    ASSERT_TRUE(BitmapAllocator_ctor(&reference,
+                                     kElementSize,
+                                     kNumMemoryElements));
+    ASSERT_EQ(0u, (uintptr_t) Test_pool_buffer % kElementSize);
+
+    for (unsigned i = 0; i < 2000; i++)
+    {
+        if (!live.empty() && (rng() % 2))
+        {
+            size_t pos = rng() % live.size();
+            size_t elementNum = live[pos];
+            live[pos] = live.back();
+            live.pop_back();
+
+            Test_pool_free(&((uint64_t*) Test_pool_buffer)[elementNum]);
+            BitmapAllocator_free(
+                BitmapAllocator_TO_ALLOCATOR(&reference),
+                &((uint64_t*) reference.baseAddr)[elementNum]);
+        }
+        else
+        {
+            size_t size = 1 + rng() % (kElementSize * 8);
+            void* addr = Test_pool_alloc(size);
+            void* referenceAddr = BitmapAllocator_alloc(
+                                      BitmapAllocator_TO_ALLOCATOR(&reference),
+                                      size);
+            if (NULL == referenceAddr)
+            {
+                ASSERT_EQ(addr, nullptr);
+            }
+            else
+            {
+                size_t elementNum = (uint64_t*) referenceAddr
+                                    - (uint64_t*) reference.baseAddr;
+                ASSERT_EQ(addr, &((uint64_t*) Test_pool_buffer)[elementNum]);
+                live.push_back(elementNum);
+            }
+        }
+        ASSERT_EQ(reference.allocatedElements,
+                  Test_pool_getAllocatedElements());
+    }
+    // not allocated, must be ignored
+    Test_pool_free(buf);
+
+    BitmapAllocator_dtor(BitmapAllocator_TO_ALLOCATOR(&reference));
+}
+
 int main(int argc, char* argv[])
 {
     testing::InitGoogleTest(&argc, argv);
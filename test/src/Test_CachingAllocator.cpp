@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+#include "lib_mem/AllocatorSafe.h"
+#include "lib_mem/BitmapAllocator.h"
+#include "lib_mem/CachingAllocator.h"
+#include <stdint.h>
+}
+
+constexpr size_t kElementSize   = 16;
+constexpr size_t kNumElements   = 4096;
+constexpr size_t kMagazineSize  = 8;
+static const size_t kClassSizes[] = { 16, 48, 112 };
+
+class Test_CachingAllocator : public testing::Test
+{
+    protected:
+        BitmapAllocator bmAllocator;
+        CachingAllocator caching;
+        Allocator* allocator = CachingAllocator_TO_ALLOCATOR(&caching);
+
+        void SetUp()
+        {
+            ASSERT_TRUE(BitmapAllocator_ctor(&bmAllocator,
+                                             kElementSize,
+                                             kNumElements));
+            ASSERT_TRUE(CachingAllocator_ctor(
+                            &caching,
+                            BitmapAllocator_TO_ALLOCATOR(&bmAllocator),
+                            kClassSizes,
+                            3,
+                            kMagazineSize));
+        }
+
+        void TearDown()
+        {
+            Allocator_dtor(allocator);
+            ASSERT_EQ(bmAllocator.allocatedElements, 0);
+            BitmapAllocator_dtor(BitmapAllocator_TO_ALLOCATOR(&bmAllocator));
+        }
+};
+
+/*----------------------------------------------------------------------------*/
+TEST(Test_CachingAllocator_ctor, invalid_classes_neg)
+{
+    static const size_t unsorted[] = { 32, 16 };
+    BitmapAllocator bmAllocator;
+    CachingAllocator caching;
+    Allocator* backing = BitmapAllocator_TO_ALLOCATOR(&bmAllocator);
+
+    ASSERT_FALSE(CachingAllocator_ctor(&caching, backing, unsorted, 2, 8));
+    ASSERT_FALSE(CachingAllocator_ctor(&caching, backing, kClassSizes, 0, 8));
+    ASSERT_FALSE(CachingAllocator_ctor(&caching, backing, kClassSizes, 3, 1));
+    ASSERT_FALSE(CachingAllocator_ctor(&caching, NULL, kClassSizes, 3, 8));
+}
+
+// A refill takes half a magazine from the backing allocator at once and the
+// freed blocks are reused without going back to it
+TEST_F(Test_CachingAllocator, refill_and_reuse_pos)
+{
+    void* block = Allocator_alloc(allocator, 10);
+    ASSERT_NE(block, nullptr);
+    ASSERT_EQ(Allocator_usableSize(allocator, block), kClassSizes[0]);
+
+    size_t backingElements = bmAllocator.allocatedElements;
+
+    Allocator_free(allocator, block);
+    ASSERT_EQ(Allocator_alloc(allocator, 16), block);
+    ASSERT_EQ(bmAllocator.allocatedElements, backingElements);
+
+    // Requests above the largest class bypass the magazines
+    void* large = Allocator_alloc(allocator, 1000);
+    ASSERT_NE(large, nullptr);
+    ASSERT_GE(Allocator_usableSize(allocator, large), 1000);
+    Allocator_free(allocator, large);
+    ASSERT_EQ(bmAllocator.allocatedElements, backingElements);
+
+    Allocator_free(allocator, block);
+    CachingAllocator_flushThread(&caching);
+    ASSERT_EQ(bmAllocator.allocatedElements, 0);
+}
+
+// Sizes that would wrap around once the header is added are rejected
+TEST_F(Test_CachingAllocator, huge_size_neg)
+{
+    ASSERT_EQ(Allocator_alloc(allocator, SIZE_MAX), nullptr);
+    ASSERT_EQ(Allocator_alloc(allocator, SIZE_MAX - 1), nullptr);
+    ASSERT_EQ(bmAllocator.allocatedElements, 0);
+}
+
+// A full magazine gives half of its blocks back
+TEST_F(Test_CachingAllocator, flush_half_of_full_magazine_pos)
+{
+    std::vector<void*> blocks;
+
+    for (size_t i = 0; i < kMagazineSize + 1; i++)
+    {
+        blocks.push_back(Allocator_alloc(allocator, 100));
+        ASSERT_NE(blocks.back(), nullptr);
+    }
+    for (void* block : blocks)
+    {
+        Allocator_free(allocator, block);
+    }
+    // blocks of 112 + header bytes take 8 elements of 16 bytes
+    size_t elementsPerBlock = (kClassSizes[2] + 16 + kElementSize - 1)
+                              / kElementSize;
+    ASSERT_LE(bmAllocator.allocatedElements,
+              (kMagazineSize + kMagazineSize / 2) * elementsPerBlock);
+    ASSERT_GE(bmAllocator.allocatedElements,
+              (kMagazineSize / 2 + 1) * elementsPerBlock);
+}
+
+// Threads share an AllocatorSafe backing, free blocks of each other and
+// flush before they exit
+TEST(Test_CachingAllocator_threads, alloc_free_and_flush_pos)
+{
+    constexpr size_t kThreads = 4;
+
+    BitmapAllocator bmAllocator;
+    AllocatorSafe safe;
+    CachingAllocator caching;
+    Mutex* mutex = Mutex_create();
+    std::vector<std::thread> threads;
+    std::vector<void*> exchange[kThreads];
+
+    ASSERT_NE(mutex, nullptr);
+    ASSERT_TRUE(BitmapAllocator_ctor(&bmAllocator, kElementSize, kNumElements));
+    ASSERT_TRUE(AllocatorSafe_ctor(&safe,
+                                   BitmapAllocator_TO_ALLOCATOR(&bmAllocator),
+                                   mutex));
+    ASSERT_TRUE(CachingAllocator_ctor(&caching,
+                                      AllocatorSafe_TO_ALLOCATOR(&safe),
+                                      kClassSizes,
+                                      3,
+                                      kMagazineSize));
+    Allocator* allocator = CachingAllocator_TO_ALLOCATOR(&caching);
+
+    for (size_t t = 0; t < kThreads; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            std::mt19937 rng(t);
+            std::vector<void*> held;
+
+            for (size_t i = 0; i < 20000; i++)
+            {
+                if (held.size() < 32 && (rng() % 2))
+                {
+                    void* block = Allocator_alloc(allocator, 1 + rng() % 200);
+                    if (block != NULL)
+                    {
+                        held.push_back(block);
+                    }
+                }
+                else if (!held.empty())
+                {
+                    Allocator_free(allocator, held.back());
+                    held.pop_back();
+                }
+            }
+            // the next thread frees them
+            exchange[(t + 1) % kThreads] = held;
+            CachingAllocator_flushThread(&caching);
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    threads.clear();
+    for (size_t t = 0; t < kThreads; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            for (void* block : exchange[t])
+            {
+                Allocator_free(allocator, block);
+            }
+            CachingAllocator_flushThread(&caching);
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    ASSERT_EQ(bmAllocator.allocatedElements, 0);
+
+    BitmapAllocator_dtor(BitmapAllocator_TO_ALLOCATOR(&bmAllocator));
+    Mutex_destroy(mutex);
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+#include "lib_mem/ConcurrentBitmapAllocator.h"
+#include <stdint.h>
+#include <limits.h>
+}
+
+// Not a multiple of the bits in a slot, so that the tail of the last slot is
+// never handed out
+constexpr size_t kNumElements = BitmapAllocator_BITS_IN_A_SLOT * 8 + 3;
+constexpr size_t kElementSize = sizeof(uint64_t);
+
+class Test_ConcurrentBitmapAllocator : public testing::Test
+{
+    protected:
+        ConcurrentBitmapAllocator cbAllocator;
+        Allocator* allocator =
+            ConcurrentBitmapAllocator_TO_ALLOCATOR(&cbAllocator);
+        Mutex* mutex = NULL;
+
+        void SetUp()
+        {
+            mutex = Mutex_create();
+            ASSERT_NE(mutex, nullptr);
+            ASSERT_TRUE(ConcurrentBitmapAllocator_ctor(&cbAllocator,
+                                                       kElementSize,
+                                                       kNumElements,
+                                                       mutex));
+        }
+
+        void TearDown()
+        {
+            Allocator_dtor(allocator);
+            Mutex_destroy(mutex);
+        }
+};
+
+/*----------------------------------------------------------------------------*/
+// Single threaded, the pool can be filled with single elements and with runs
+TEST_F(Test_ConcurrentBitmapAllocator, allocate_all_and_free_pos)
+{
+    std::vector<void*> blocks;
+
+    for (size_t i = 0; i < kNumElements; i++)
+    {
+        void* addr = Allocator_alloc(allocator, kElementSize);
+        ASSERT_NE(addr, nullptr);
+        blocks.push_back(addr);
+    }
+    ASSERT_EQ(Allocator_alloc(allocator, kElementSize), nullptr);
+    ASSERT_EQ(cbAllocator.allocatedElements, kNumElements);
+
+    // Free three neighbours and take them back as one run
+    Allocator_free(allocator, blocks[10]);
+    Allocator_free(allocator, blocks[11]);
+    Allocator_free(allocator, blocks[12]);
+    ASSERT_EQ(Allocator_alloc(allocator, kElementSize * 4), nullptr);
+    void* run = Allocator_alloc(allocator, kElementSize * 3);
+    ASSERT_EQ(run, blocks[10]);
+    ASSERT_EQ(Allocator_usableSize(allocator, run), kElementSize * 3);
+
+    Allocator_free(allocator, run);
+    for (size_t i = 0; i < kNumElements; i++)
+    {
+        if (i < 10 || i > 12)
+        {
+            Allocator_free(allocator, blocks[i]);
+        }
+    }
+    ASSERT_EQ(cbAllocator.allocatedElements, 0);
+    ASSERT_EQ(Allocator_alloc(allocator, kElementSize * kNumElements),
+              blocks[0]);
+}
+
+// Threads allocate single elements and runs concurrently and record the owner
+// of every element they get, an element that already has an owner would be a
+// double allocation.
+TEST_F(Test_ConcurrentBitmapAllocator, no_double_allocation_stress_pos)
+{
+    constexpr size_t kThreads = 8;
+    constexpr size_t kIterations = 20000;
+    constexpr size_t kHeld = 16;
+
+    std::vector<std::atomic<unsigned>> owners(kNumElements);
+    std::atomic<size_t> errors(0);
+    std::vector<std::thread> threads;
+    uint64_t* base = (uint64_t*) cbAllocator.baseAddr;
+
+    for (auto& owner : owners)
+    {
+        owner = 0;
+    }
+
+    for (unsigned t = 1; t <= kThreads; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            std::mt19937 rng(t);
+            std::vector<std::pair<uint64_t*, size_t>> held;
+
+            for (size_t i = 0; i < kIterations; i++)
+            {
+                if (held.size() < kHeld)
+                {
+                    // mostly single elements, some runs
+                    size_t numElements = (rng() % 8) ? 1 : 2 + rng() % 6;
+                    uint64_t* addr = (uint64_t*) Allocator_alloc(
+                                         allocator,
+                                         numElements * kElementSize);
+                    if (NULL == addr)
+                    {
+                        continue;
+                    }
+                    for (size_t e = 0; e < numElements; e++)
+                    {
+                        unsigned expected = 0;
+                        if (!owners[addr - base + e].compare_exchange_strong(
+                                expected, t))
+                        {
+                            errors++;
+                        }
+                        addr[e] = t;
+                    }
+                    held.emplace_back(addr, numElements);
+                }
+                else
+                {
+                    size_t pos = rng() % held.size();
+                    uint64_t* addr = held[pos].first;
+                    size_t numElements = held[pos].second;
+
+                    held[pos] = held.back();
+                    held.pop_back();
+                    for (size_t e = 0; e < numElements; e++)
+                    {
+                        if (addr[e] != t)
+                        {
+                            errors++;
+                        }
+                        owners[addr - base + e] = 0;
+                    }
+                    Allocator_free(allocator, addr);
+                }
+            }
+            for (auto& block : held)
+            {
+                for (size_t e = 0; e < block.second; e++)
+                {
+                    owners[block.first - base + e] = 0;
+                }
+                Allocator_free(allocator, block.first);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    ASSERT_EQ(errors, 0);
+    ASSERT_EQ(cbAllocator.allocatedElements, 0);
+    for (size_t slot = 0;
+         slot < BitmapAllocator_BITMAP_SIZE(kNumElements)
+         / sizeof(BitmapAllocator_BitmapSlot);
+         slot++)
+    {
+        ASSERT_EQ(cbAllocator.bitmap[slot], 0);
+        ASSERT_EQ(cbAllocator.boundaryBitmap[slot], 0);
+    }
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+#include "lib_mem/BitmapAllocator.h"
+#include "lib_mem/DeferredFreeAllocator.h"
+#include <stdint.h>
+}
+
+constexpr size_t kElementSize = sizeof(void*);
+constexpr size_t kNumElements = 1024;
+
+class Test_DeferredFreeAllocator : public testing::Test
+{
+    protected:
+        BitmapAllocator bmAllocator;
+        DeferredFreeAllocator deferred;
+        Allocator* allocator = DeferredFreeAllocator_TO_ALLOCATOR(&deferred);
+
+        void SetUp()
+        {
+            ASSERT_TRUE(BitmapAllocator_ctor(&bmAllocator,
+                                             kElementSize,
+                                             kNumElements));
+            ASSERT_TRUE(DeferredFreeAllocator_ctor(
+                            &deferred,
+                            BitmapAllocator_TO_ALLOCATOR(&bmAllocator)));
+        }
+
+        void TearDown()
+        {
+            Allocator_dtor(allocator);
+            ASSERT_EQ(bmAllocator.allocatedElements, 0);
+            BitmapAllocator_dtor(BitmapAllocator_TO_ALLOCATOR(&bmAllocator));
+        }
+};
+
+/*----------------------------------------------------------------------------*/
+TEST(Test_DeferredFreeAllocator_ctor, no_impl_neg)
+{
+    DeferredFreeAllocator deferred;
+
+    ASSERT_FALSE(DeferredFreeAllocator_ctor(&deferred, NULL));
+}
+
+// The owner frees directly, the frees of other threads wait for a drain
+TEST_F(Test_DeferredFreeAllocator, owner_and_remote_free_pos)
+{
+    void* own = Allocator_alloc(allocator, kElementSize);
+    void* remote[3];
+
+    ASSERT_NE(own, nullptr);
+    for (auto& block : remote)
+    {
+        block = Allocator_alloc(allocator, 2 * kElementSize);
+        ASSERT_NE(block, nullptr);
+    }
+    Allocator_free(allocator, own);
+    ASSERT_EQ(bmAllocator.allocatedElements, 6);
+
+    std::thread([&]()
+    {
+        for (auto block : remote)
+        {
+            Allocator_free(allocator, block);
+        }
+    }).join();
+    ASSERT_EQ(bmAllocator.allocatedElements, 6);
+
+    ASSERT_EQ(DeferredFreeAllocator_drain(&deferred), 3);
+    ASSERT_EQ(bmAllocator.allocatedElements, 0);
+    ASSERT_EQ(DeferredFreeAllocator_drain(&deferred), 0);
+
+    // the next allocation drains too
+    void* block = Allocator_alloc(allocator, kElementSize);
+    std::thread([&]() { Allocator_free(allocator, block); }).join();
+    ASSERT_EQ(Allocator_alloc(allocator, kElementSize), block);
+    Allocator_free(allocator, block);
+}
+
+// Small requests are rounded up to hold the link, which needs no alignment
+TEST(Test_DeferredFreeAllocator_small, unaligned_blocks_pos)
+{
+    BitmapAllocator bmAllocator;
+    DeferredFreeAllocator deferred;
+    Allocator* allocator = DeferredFreeAllocator_TO_ALLOCATOR(&deferred);
+    void* blocks[8];
+
+    // elements of 3 bytes put most of the blocks at odd addresses
+    ASSERT_TRUE(BitmapAllocator_ctor(&bmAllocator, 3, 64));
+    ASSERT_TRUE(DeferredFreeAllocator_ctor(
+                    &deferred,
+                    BitmapAllocator_TO_ALLOCATOR(&bmAllocator)));
+    for (auto& block : blocks)
+    {
+        block = Allocator_alloc(allocator, 1);
+        ASSERT_NE(block, nullptr);
+        ASSERT_GE(Allocator_usableSize(allocator, block),
+                  DeferredFreeAllocator_MIN_BLOCK_SIZE);
+    }
+    std::thread([&]()
+    {
+        for (auto block : blocks)
+        {
+            Allocator_free(allocator, block);
+        }
+    }).join();
+    ASSERT_EQ(DeferredFreeAllocator_drain(&deferred), 8);
+    ASSERT_EQ(bmAllocator.allocatedElements, 0);
+
+    Allocator_dtor(allocator);
+    BitmapAllocator_dtor(BitmapAllocator_TO_ALLOCATOR(&bmAllocator));
+}
+
+// One producer allocates messages, several consumers free them
+TEST_F(Test_DeferredFreeAllocator, producer_consumers_pos)
+{
+    constexpr size_t kConsumers = 4;
+    constexpr size_t kMessages  = 50000;
+    std::mutex queueLock;
+    std::vector<uint64_t*> queue;
+    std::atomic<bool> done(false);
+    std::vector<std::thread> consumers;
+
+    for (size_t t = 0; t < kConsumers; t++)
+    {
+        consumers.emplace_back([&]()
+        {
+            for (;;)
+            {
+                uint64_t* msg = NULL;
+                {
+                    std::lock_guard<std::mutex> guard(queueLock);
+                    if (!queue.empty())
+                    {
+                        msg = queue.back();
+                        queue.pop_back();
+                    }
+                }
+                if (msg != NULL)
+                {
+                    ASSERT_EQ(msg[0], msg[1]);
+                    Allocator_free(allocator, msg);
+                }
+                else if (done)
+                {
+                    break;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (size_t i = 0; i < kMessages; i++)
+    {
+        uint64_t* msg = (uint64_t*) Allocator_alloc(allocator,
+                                                    2 * sizeof(uint64_t));
+        if (NULL == msg)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        msg[0] = i;
+        msg[1] = i;
+        std::lock_guard<std::mutex> guard(queueLock);
+        queue.push_back(msg);
+    }
+    done = true;
+    for (auto& consumer : consumers)
+    {
+        consumer.join();
+    }
+    DeferredFreeAllocator_drain(&deferred);
+    ASSERT_EQ(bmAllocator.allocatedElements, 0);
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <gtest/gtest.h>
+
+// the other tests use the stdlib heap
+#undef MEMORY_CONFIG_H_FILE
+#define MEMORY_CONFIG_H_FILE mem_config_allocator.h
+
+extern "C"
+{
+#include "lib_mem/Memory.h"
+#include <stdint.h>
+
+BitmapAllocator Test_Memory_heap;
+}
+
+constexpr size_t kElementSize = 16;
+constexpr size_t kNumElements = 64;
+
+class Test_Memory : public testing::Test
+{
+    protected:
+        alignas(kElementSize) uint8_t buffer[kElementSize * kNumElements];
+        BitmapAllocator_BitmapSlot
+        bitmap[BitmapAllocator_BITMAP_SIZE(kNumElements)
+               / sizeof(BitmapAllocator_BitmapSlot)] = { 0 };
+        BitmapAllocator_BitmapSlot
+        boundaryBitmap[BitmapAllocator_BITMAP_SIZE(kNumElements)
+                       / sizeof(BitmapAllocator_BitmapSlot)] = { 0 };
+
+        void SetUp()
+        {
+            ASSERT_TRUE(BitmapAllocator_ctorStatic(&Test_Memory_heap,
+                                                   buffer,
+                                                   bitmap,
+                                                   boundaryBitmap,
+                                                   kElementSize,
+                                                   kNumElements));
+        }
+
+        void TearDown()
+        {
+            ASSERT_EQ(Test_Memory_heap.allocatedElements, 0);
+        }
+};
+
+/*----------------------------------------------------------------------------*/
+TEST_F(Test_Memory, heap_is_the_allocator_pos)
+{
+    uint8_t* block = (uint8_t*) Memory_alloc(3 * kElementSize);
+
+    ASSERT_EQ(block, buffer);
+    ASSERT_EQ(Test_Memory_heap.allocatedElements, 3);
+
+    uint8_t* zeroed = (uint8_t*) Memory_calloc(4, 8);
+    ASSERT_EQ(zeroed, buffer + 3 * kElementSize);
+    for (size_t i = 0; i < 32; i++)
+    {
+        ASSERT_EQ(zeroed[i], 0);
+    }
+    ASSERT_EQ(Memory_calloc(SIZE_MAX / 2, 4), nullptr);
+
+    block[0] = 0x42;
+    block = (uint8_t*) Memory_realloc(block, 5 * kElementSize);
+    ASSERT_NE(block, nullptr);
+    ASSERT_EQ(block[0], 0x42);
+
+    Memory_free(zeroed);
+    Memory_free(block);
+}
+
+// Memory_Config_ALLOCATOR_IMPL calls the BitmapAllocator functions without
+// looking at the vtable
+TEST_F(Test_Memory, direct_calls_pos)
+{
+    static const Allocator_Vtable broken = {};
+    const Allocator_Vtable* vtable = Test_Memory_heap.parent.vtable;
+
+    Test_Memory_heap.parent.vtable = &broken;
+    void* block = Memory_alloc(kElementSize);
+    ASSERT_EQ(block, buffer);
+    Memory_free(block);
+    Test_Memory_heap.parent.vtable = vtable;
+}
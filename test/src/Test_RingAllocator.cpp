@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <random>
+#include <stddef.h>
+#include <vector>
+
+extern "C"
+{
+#include "lib_mem/RingAllocator.h"
+#include <stdint.h>
+}
+
+constexpr size_t kAlign     = alignof(max_align_t);
+constexpr size_t kBlockSize = 4 * kAlign;
+// header and payload of a block of kBlockSize bytes
+constexpr size_t kSlotSize  = kBlockSize + kAlign;
+constexpr size_t kRingSize  = 10 * kSlotSize;
+
+class Test_RingAllocator : public testing::Test
+{
+    protected:
+        RingAllocator ring;
+        Allocator* allocator = RingAllocator_TO_ALLOCATOR(&ring);
+
+        void SetUp()
+        {
+            ASSERT_TRUE(RingAllocator_ctor(&ring, kRingSize));
+        }
+
+        void TearDown()
+        {
+            ASSERT_EQ(ring.headSeq, ring.tailSeq);
+            Allocator_dtor(allocator);
+        }
+};
+
+/*----------------------------------------------------------------------------*/
+TEST(Test_RingAllocator_ctor, invalid_buffer_neg)
+{
+    alignas(max_align_t) static uint8_t buffer[kAlign];
+    RingAllocator ring;
+
+    ASSERT_FALSE(RingAllocator_ctorStatic(&ring, NULL, kRingSize));
+    ASSERT_FALSE(RingAllocator_ctorStatic(&ring, buffer, sizeof(buffer)));
+}
+
+// Blocks follow each other, a block that does not fit at the end starts at
+// the beginning once the tail has moved on
+TEST_F(Test_RingAllocator, fifo_and_wrap_pos)
+{
+    std::deque<uint8_t*> blocks;
+
+    for (size_t i = 0; i < kRingSize / kSlotSize; i++)
+    {
+        blocks.push_back((uint8_t*) Allocator_alloc(allocator, kBlockSize));
+        ASSERT_NE(blocks.back(), nullptr);
+        ASSERT_EQ((uintptr_t) blocks.back() % kAlign, 0);
+        if (i)
+        {
+            ASSERT_EQ(blocks.back(), blocks[i - 1] + kSlotSize);
+        }
+    }
+    ASSERT_EQ(Allocator_alloc(allocator, 1), nullptr);
+    ASSERT_EQ(Allocator_usableSize(allocator, blocks[0]), kBlockSize);
+
+    // two slots free at the start, a block of two slots fits there
+    uint8_t* first = blocks[0];
+    Allocator_free(allocator, blocks[0]);
+    Allocator_free(allocator, blocks[1]);
+    blocks.erase(blocks.begin(), blocks.begin() + 2);
+    uint8_t* wrapped = (uint8_t*) Allocator_alloc(allocator,
+                                                  kBlockSize + kSlotSize);
+    ASSERT_EQ(wrapped, first);
+    ASSERT_EQ(Allocator_alloc(allocator, 1), nullptr);
+    blocks.push_back(wrapped);
+
+    while (!blocks.empty())
+    {
+        Allocator_free(allocator, blocks.front());
+        blocks.pop_front();
+    }
+    // an empty ring starts over
+    void* block = Allocator_alloc(allocator, kRingSize - kAlign);
+    ASSERT_NE(block, nullptr);
+    Allocator_free(allocator, block);
+}
+
+// Blocks freed out of order are reclaimed with the oldest one
+TEST_F(Test_RingAllocator, out_of_order_free_pos)
+{
+    void* blocks[3];
+
+    for (auto& block : blocks)
+    {
+        block = Allocator_alloc(allocator, kBlockSize);
+    }
+    Allocator_free(allocator, blocks[2]);
+    Allocator_free(allocator, blocks[1]);
+    ASSERT_EQ(ring.tailSeq, 0);
+    ASSERT_EQ(ring.pending, 6);
+
+    // freeing twice is caught
+    Allocator_free(allocator, blocks[1]);
+    ASSERT_EQ(Allocator_usableSize(allocator, blocks[1]), 0);
+    Allocator_free(allocator, (uint8_t*) blocks[0] + kAlign);
+
+    Allocator_free(allocator, blocks[0]);
+    ASSERT_EQ(ring.tailSeq, 3);
+    ASSERT_EQ(ring.pending, 0);
+}
+
+// No more than RingAllocator_MAX_BLOCKS blocks at a time
+TEST(Test_RingAllocator_limit, max_blocks_pos)
+{
+    RingAllocator ring;
+    Allocator* allocator = RingAllocator_TO_ALLOCATOR(&ring);
+    std::vector<void*> blocks;
+
+    ASSERT_TRUE(RingAllocator_ctor(&ring, 200 * kSlotSize));
+    for (size_t i = 0; i < RingAllocator_MAX_BLOCKS; i++)
+    {
+        blocks.push_back(Allocator_alloc(allocator, 1));
+        ASSERT_NE(blocks.back(), nullptr);
+    }
+    ASSERT_EQ(Allocator_alloc(allocator, 1), nullptr);
+
+    // all the blocks but the oldest, then the oldest releases them at once
+    for (size_t i = RingAllocator_MAX_BLOCKS - 1; i > 0; i--)
+    {
+        Allocator_free(allocator, blocks[i]);
+    }
+    Allocator_free(allocator, blocks[0]);
+    ASSERT_EQ(ring.tailSeq, RingAllocator_MAX_BLOCKS);
+    ASSERT_EQ(ring.headSeq, ring.tailSeq);
+
+    Allocator_dtor(allocator);
+}
+
+// Mostly FIFO traffic with a few late frees keeps the content of the blocks
+TEST_F(Test_RingAllocator, streaming_pos)
+{
+    std::mt19937 rng(5);
+    std::deque<std::pair<uint8_t*, size_t>> live;
+
+    for (size_t i = 0; i < 20000; i++)
+    {
+        size_t size = 1 + rng() % (2 * kBlockSize);
+        uint8_t* block = (uint8_t*) Allocator_alloc(allocator, size);
+
+        if (block != NULL)
+        {
+            memset(block, (int) (i & 0xFF), size);
+            live.emplace_back(block, i);
+        }
+        if (!live.empty() && (NULL == block || live.size() > 4))
+        {
+            // one in eight frees takes the second oldest one
+            size_t pos = (live.size() > 1 && !(rng() % 8)) ? 1 : 0;
+            auto entry = live[pos];
+            size_t usable = Allocator_usableSize(allocator, entry.first);
+            ASSERT_GT(usable, 0);
+            ASSERT_EQ(entry.first[0], entry.second & 0xFF);
+            Allocator_free(allocator, entry.first);
+            live.erase(live.begin() + pos);
+        }
+    }
+    for (auto& entry : live)
+    {
+        Allocator_free(allocator, entry.first);
+    }
+}
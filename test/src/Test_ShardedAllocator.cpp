@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+#include "lib_mem/ShardedAllocator.h"
+#include <stdint.h>
+}
+
+constexpr size_t kNumArenas   = 4;
+constexpr size_t kNumElements = 256;
+constexpr size_t kElementSize = sizeof(uint64_t);
+
+class Test_ShardedAllocator : public testing::Test
+{
+    protected:
+        ShardedAllocator_Arena arenas[kNumArenas];
+        Mutex* mutexes[kNumArenas] = { NULL };
+        ShardedAllocator sharded;
+        Allocator* allocator = ShardedAllocator_TO_ALLOCATOR(&sharded);
+
+        void SetUp()
+        {
+            for (auto& mutex : mutexes)
+            {
+                mutex = Mutex_create();
+                ASSERT_NE(mutex, nullptr);
+            }
+            ASSERT_TRUE(ShardedAllocator_ctor(&sharded,
+                                              arenas,
+                                              kNumArenas,
+                                              kElementSize,
+                                              kNumElements,
+                                              mutexes));
+        }
+
+        void TearDown()
+        {
+            for (auto& arena : arenas)
+            {
+                ASSERT_EQ(arena.bmAllocator.allocatedElements, 0);
+            }
+            Allocator_dtor(allocator);
+            for (auto& mutex : mutexes)
+            {
+                Mutex_destroy(mutex);
+            }
+        }
+};
+
+/*----------------------------------------------------------------------------*/
+TEST(Test_ShardedAllocator_ctor, invalid_arenas_neg)
+{
+    static uint8_t buffer[2 * kNumElements * kElementSize];
+    static BitmapAllocator_BitmapSlot
+    bitmaps[4][BitmapAllocator_BITMAP_SIZE(kNumElements)
+               / sizeof(BitmapAllocator_BitmapSlot)];
+    ShardedAllocator_Arena arenas[2];
+    Mutex* mutexes[2] = { Mutex_create(), NULL };
+    ShardedAllocator sharded;
+
+    ASSERT_FALSE(ShardedAllocator_ctor(&sharded, arenas, 0, kElementSize,
+                                       kNumElements, mutexes));
+    ASSERT_FALSE(ShardedAllocator_ctor(&sharded, arenas, 2, kElementSize,
+                                       kNumElements, mutexes));
+
+    // the second pool starts in the middle of the first one
+    for (size_t i = 0; i < 2; i++)
+    {
+        ASSERT_TRUE(BitmapAllocator_ctorStatic(
+                        &arenas[i].bmAllocator,
+                        &buffer[i * kNumElements * kElementSize / 2],
+                        bitmaps[2 * i],
+                        bitmaps[2 * i + 1],
+                        kElementSize,
+                        kNumElements));
+        arenas[i].mutex = mutexes[0];
+    }
+    ASSERT_FALSE(ShardedAllocator_ctorStatic(&sharded, arenas, 2));
+
+    Mutex_destroy(mutexes[0]);
+}
+
+// A thread stays on its home arena until it is full, frees find their arena
+// whatever the order of the pools in memory
+TEST_F(Test_ShardedAllocator, spill_and_route_free_pos)
+{
+    std::vector<void*> blocks;
+
+    for (size_t i = 0; i < kNumArenas * kNumElements; i++)
+    {
+        void* addr = Allocator_alloc(allocator, kElementSize);
+        ASSERT_NE(addr, nullptr);
+        blocks.push_back(addr);
+    }
+    ASSERT_EQ(Allocator_alloc(allocator, kElementSize), nullptr);
+
+    for (size_t i = 1; i < kNumArenas; i++)
+    {
+        ASSERT_LT(arenas[i - 1].bmAllocator.baseAddr,
+                  arenas[i].bmAllocator.baseAddr);
+    }
+    // the first block of every arena comes right after the previous one is
+    // full
+    for (size_t i = 0; i < blocks.size(); i += kNumElements)
+    {
+        size_t owners = 0;
+        for (auto& arena : arenas)
+        {
+            owners += (blocks[i] == arena.bmAllocator.baseAddr);
+        }
+        ASSERT_EQ(owners, 1);
+    }
+
+    ASSERT_EQ(Allocator_usableSize(allocator, blocks[kNumElements]),
+              kElementSize);
+    int outside = 0;
+    ASSERT_EQ(Allocator_usableSize(allocator, &outside), 0);
+    Allocator_free(allocator, &outside);
+
+    for (void* block : blocks)
+    {
+        Allocator_free(allocator, block);
+    }
+}
+
+// Threads allocate, write and free concurrently, nobody gets a block twice
+TEST_F(Test_ShardedAllocator, threads_pos)
+{
+    constexpr size_t kThreads = 8;
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < kThreads; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            std::mt19937 rng(t);
+            std::vector<uint64_t*> held;
+
+            for (size_t i = 0; i < 20000; i++)
+            {
+                if (held.size() < 64 && (rng() % 2))
+                {
+                    size_t num = 1 + rng() % 4;
+                    uint64_t* block = (uint64_t*) Allocator_alloc(
+                                          allocator, num * kElementSize);
+                    if (block != NULL)
+                    {
+                        for (size_t j = 0; j < num; j++)
+                        {
+                            block[j] = t;
+                        }
+                        held.push_back(block);
+                    }
+                }
+                else if (!held.empty())
+                {
+                    size_t pos = rng() % held.size();
+                    uint64_t* block = held[pos];
+                    size_t num = Allocator_usableSize(allocator, block)
+                                 / kElementSize;
+                    for (size_t j = 0; j < num; j++)
+                    {
+                        ASSERT_EQ(block[j], t);
+                    }
+                    Allocator_free(allocator, block);
+                    held[pos] = held.back();
+                    held.pop_back();
+                }
+            }
+            for (uint64_t* block : held)
+            {
+                Allocator_free(allocator, block);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+extern "C"
+{
+#include "lib_mem/BitmapAllocator.h"
+#include "lib_mem/SizeClassAllocator.h"
+#include "lib_mem/SlabAllocator.h"
+#include <stdint.h>
+}
+
+constexpr size_t kSlotSize      = 32;
+constexpr size_t kNumSlots      = 16;
+constexpr size_t kElementSize   = 256;
+constexpr size_t kNumElements   = 16;
+
+// a slab for the small requests and a bitmap pool for the medium ones, all
+// static, with a dynamic pool behind them
+class Test_SizeClassAllocator : public testing::Test
+{
+    protected:
+        uint8_t slabBuffer[kSlotSize * kNumSlots];
+        uint8_t bitmapBuffer[kElementSize * kNumElements];
+        BitmapAllocator_BitmapSlot
+        bitmap[BitmapAllocator_BITMAP_SIZE(kNumElements)
+               / sizeof(BitmapAllocator_BitmapSlot)] = { 0 };
+        BitmapAllocator_BitmapSlot
+        boundaryBitmap[BitmapAllocator_BITMAP_SIZE(kNumElements)
+                       / sizeof(BitmapAllocator_BitmapSlot)] = { 0 };
+
+        SlabAllocator slab;
+        BitmapAllocator medium;
+        BitmapAllocator large;
+        SizeClassAllocator_Class classes[2];
+        SizeClassAllocator sizeClass;
+        Allocator* allocator = SizeClassAllocator_TO_ALLOCATOR(&sizeClass);
+
+        void SetUp()
+        {
+            ASSERT_TRUE(SlabAllocator_ctorStatic(&slab, slabBuffer, kSlotSize,
+                                                 kNumSlots));
+            ASSERT_TRUE(BitmapAllocator_ctorStatic(&medium, bitmapBuffer,
+                                                   bitmap, boundaryBitmap,
+                                                   kElementSize,
+                                                   kNumElements));
+            ASSERT_TRUE(BitmapAllocator_ctor(&large, 1024, 16));
+
+            classes[0] = { kSlotSize, SlabAllocator_TO_ALLOCATOR(&slab),
+                           slabBuffer, sizeof(slabBuffer) };
+            classes[1] = { 4 * kElementSize,
+                           BitmapAllocator_TO_ALLOCATOR(&medium),
+                           bitmapBuffer, sizeof(bitmapBuffer) };
+            ASSERT_TRUE(SizeClassAllocator_ctor(
+                            &sizeClass, classes, 2,
+                            BitmapAllocator_TO_ALLOCATOR(&large)));
+        }
+
+        void TearDown()
+        {
+            ASSERT_EQ(slab.allocatedSlots, 0);
+            ASSERT_EQ(medium.allocatedElements, 0);
+            ASSERT_EQ(large.allocatedElements, 0);
+            Allocator_dtor(allocator);
+            BitmapAllocator_dtor(BitmapAllocator_TO_ALLOCATOR(&large));
+        }
+
+        bool isIn(void* ptr, const uint8_t* buffer, size_t size)
+        {
+            return (uint8_t*) ptr >= buffer && (uint8_t*) ptr < buffer + size;
+        }
+};
+
+/*----------------------------------------------------------------------------*/
+TEST_F(Test_SizeClassAllocator, invalid_table_neg)
+{
+    SizeClassAllocator other;
+    SizeClassAllocator_Class swapped[2] = { classes[1], classes[0] };
+    SizeClassAllocator_Class overlapping[2] = { classes[0], classes[1] };
+
+    overlapping[1].base = slabBuffer + kSlotSize;
+
+    ASSERT_FALSE(SizeClassAllocator_ctor(&other, NULL, 2, NULL));
+    ASSERT_FALSE(SizeClassAllocator_ctor(&other, classes, 0, NULL));
+    ASSERT_FALSE(SizeClassAllocator_ctor(&other, swapped, 2, NULL));
+    ASSERT_FALSE(SizeClassAllocator_ctor(&other, overlapping, 2, NULL));
+}
+
+// Requests go to the class covering them, frees go back by address
+TEST_F(Test_SizeClassAllocator, route_by_size_and_addr_pos)
+{
+    void* small = Allocator_alloc(allocator, 24);
+    void* edge = Allocator_alloc(allocator, kSlotSize);
+    void* mediumBlock = Allocator_alloc(allocator, kSlotSize + 1);
+    void* largeBlock = Allocator_alloc(allocator, 4 * kElementSize + 1);
+
+    ASSERT_TRUE(isIn(small, slabBuffer, sizeof(slabBuffer)));
+    ASSERT_TRUE(isIn(edge, slabBuffer, sizeof(slabBuffer)));
+    ASSERT_TRUE(isIn(mediumBlock, bitmapBuffer, sizeof(bitmapBuffer)));
+    ASSERT_NE(largeBlock, nullptr);
+    ASSERT_FALSE(isIn(largeBlock, bitmapBuffer, sizeof(bitmapBuffer)));
+    ASSERT_EQ(Allocator_alloc(allocator, 0), nullptr);
+
+    ASSERT_EQ(Allocator_usableSize(allocator, small), kSlotSize);
+    ASSERT_EQ(Allocator_usableSize(allocator, mediumBlock), kElementSize);
+    ASSERT_EQ(Allocator_usableSize(allocator, largeBlock), 2048);
+
+    Allocator_free(allocator, small);
+    Allocator_free(allocator, edge);
+    Allocator_free(allocator, mediumBlock);
+    Allocator_free(allocator, largeBlock);
+}
+
+// A full class spills over to the fallback
+TEST_F(Test_SizeClassAllocator, spill_to_fallback_pos)
+{
+    std::vector<void*> blocks;
+
+    for (size_t i = 0; i < kNumSlots + 2; i++)
+    {
+        blocks.push_back(Allocator_alloc(allocator, 8));
+        ASSERT_NE(blocks.back(), nullptr);
+    }
+    ASSERT_EQ(slab.allocatedSlots, kNumSlots);
+    ASSERT_EQ(large.allocatedElements, 2);
+
+    for (void* block : blocks)
+    {
+        Allocator_free(allocator, block);
+    }
+}
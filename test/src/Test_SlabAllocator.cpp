@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+#include "lib_mem/AllocatorSafe.h"
+#include "lib_mem/SlabAllocator.h"
+#include <stdint.h>
+}
+
+// Not a multiple of the pointer alignment
+constexpr size_t kSlotSize = sizeof(void*) + 4;
+constexpr size_t kNumSlots = 100;
+
+class Test_SlabAllocator : public testing::Test
+{
+    protected:
+        SlabAllocator slab;
+        Allocator* allocator = SlabAllocator_TO_ALLOCATOR(&slab);
+
+        void SetUp()
+        {
+            ASSERT_TRUE(SlabAllocator_ctor(&slab, kSlotSize, kNumSlots));
+        }
+
+        void TearDown()
+        {
+            ASSERT_EQ(slab.allocatedSlots, 0);
+            Allocator_dtor(allocator);
+        }
+};
+
+/*----------------------------------------------------------------------------*/
+TEST(Test_SlabAllocator_ctor, invalid_args_neg)
+{
+    static uint8_t buffer[kSlotSize * kNumSlots];
+    SlabAllocator slab;
+
+    ASSERT_FALSE(SlabAllocator_ctorStatic(&slab, NULL, kSlotSize, kNumSlots));
+    ASSERT_FALSE(SlabAllocator_ctorStatic(&slab, buffer, kSlotSize, 0));
+    ASSERT_FALSE(SlabAllocator_ctorStatic(&slab, buffer, sizeof(void*) - 1,
+                                          kNumSlots));
+}
+
+// The construction does not touch the buffer, slots are handed out in order
+// until the first free
+TEST(Test_SlabAllocator_ctor, lazy_static_pos)
+{
+    static uint8_t buffer[kSlotSize * kNumSlots];
+    SlabAllocator slab;
+    Allocator* allocator = SlabAllocator_TO_ALLOCATOR(&slab);
+
+    memset(buffer, 0xA5, sizeof(buffer));
+    ASSERT_TRUE(SlabAllocator_ctorStatic(&slab, buffer, kSlotSize, kNumSlots));
+    for (uint8_t byte : buffer)
+    {
+        ASSERT_EQ(byte, 0xA5);
+    }
+    ASSERT_EQ(Allocator_alloc(allocator, kSlotSize), &buffer[0]);
+    ASSERT_EQ(Allocator_alloc(allocator, 1), &buffer[kSlotSize]);
+    ASSERT_EQ(slab.usedSlots, 2);
+}
+
+TEST_F(Test_SlabAllocator, alloc_all_and_reuse_pos)
+{
+    std::set<void*> blocks;
+
+    ASSERT_EQ(Allocator_alloc(allocator, 0), nullptr);
+    ASSERT_EQ(Allocator_alloc(allocator, kSlotSize + 1), nullptr);
+
+    for (size_t i = 0; i < kNumSlots; i++)
+    {
+        void* block = Allocator_alloc(allocator, kSlotSize);
+        ASSERT_NE(block, nullptr);
+        ASSERT_EQ(Allocator_usableSize(allocator, block), kSlotSize);
+        memset(block, 0xFF, kSlotSize);
+        blocks.insert(block);
+    }
+    ASSERT_EQ(blocks.size(), kNumSlots);
+    ASSERT_EQ(Allocator_alloc(allocator, kSlotSize), nullptr);
+
+    // the last freed slot comes back first
+    void* first = *blocks.begin();
+    void* last = *blocks.rbegin();
+    Allocator_free(allocator, first);
+    Allocator_free(allocator, last);
+    ASSERT_EQ(Allocator_alloc(allocator, kSlotSize), last);
+    ASSERT_EQ(Allocator_alloc(allocator, kSlotSize), first);
+
+    // not the start of a slot
+    Allocator_free(allocator, (uint8_t*) first + 1);
+    ASSERT_EQ(slab.allocatedSlots, kNumSlots);
+
+    for (void* block : blocks)
+    {
+        Allocator_free(allocator, block);
+    }
+}
+
+// Works behind AllocatorSafe like any other allocator
+TEST_F(Test_SlabAllocator, allocator_safe_pos)
+{
+    constexpr size_t kThreads = 4;
+    AllocatorSafe safe;
+    Mutex* mutex = Mutex_create();
+    std::vector<std::thread> threads;
+
+    ASSERT_NE(mutex, nullptr);
+    ASSERT_TRUE(AllocatorSafe_ctor(&safe, allocator, mutex));
+    Allocator* safeAllocator = AllocatorSafe_TO_ALLOCATOR(&safe);
+
+    for (size_t t = 0; t < kThreads; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            std::mt19937 rng(t);
+            std::vector<uint8_t*> held;
+
+            for (size_t i = 0; i < 20000; i++)
+            {
+                if (held.size() < kNumSlots / kThreads && (rng() % 2))
+                {
+                    uint8_t* block = (uint8_t*) Allocator_alloc(safeAllocator,
+                                                                kSlotSize);
+                    ASSERT_NE(block, nullptr);
+                    memset(block, (int) t, kSlotSize);
+                    held.push_back(block);
+                }
+                else if (!held.empty())
+                {
+                    uint8_t* block = held.back();
+                    for (size_t j = 0; j < kSlotSize; j++)
+                    {
+                        ASSERT_EQ(block[j], t);
+                    }
+                    Allocator_free(safeAllocator, block);
+                    held.pop_back();
+                }
+            }
+            Allocator_freeBatch(safeAllocator, (void**) held.data(),
+                                held.size());
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    Allocator_dtor(safeAllocator);
+    Mutex_destroy(mutex);
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <vector>
+
+extern "C"
+{
+#include "lib_mem/TlsfAllocator.h"
+#include <stdint.h>
+}
+
+constexpr size_t kPoolSize = 64 * 1024;
+constexpr size_t kHeaderSize = TlsfAllocator_ALIGN_SIZE;
+
+class Test_TlsfAllocator : public testing::Test
+{
+    protected:
+        alignas(TlsfAllocator_ALIGN_SIZE) uint8_t buffer[kPoolSize];
+        TlsfAllocator tlsf;
+        Allocator* allocator = TlsfAllocator_TO_ALLOCATOR(&tlsf);
+        size_t initialFreeBytes = 0;
+
+        void SetUp()
+        {
+            ASSERT_TRUE(TlsfAllocator_ctorStatic(&tlsf, buffer, kPoolSize));
+            initialFreeBytes = TlsfAllocator_getFreeBytes(&tlsf);
+        }
+
+        void TearDown()
+        {
+            ASSERT_EQ(TlsfAllocator_getUsedBytes(&tlsf), 0);
+            ASSERT_EQ(TlsfAllocator_getFreeBytes(&tlsf), initialFreeBytes);
+            Allocator_dtor(allocator);
+        }
+};
+
+/*----------------------------------------------------------------------------*/
+TEST(Test_TlsfAllocator_ctor, invalid_buffer_neg)
+{
+    static uint8_t buffer[3 * kHeaderSize];
+    TlsfAllocator tlsf;
+
+    ASSERT_FALSE(TlsfAllocator_ctorStatic(&tlsf, NULL, kPoolSize));
+    ASSERT_FALSE(TlsfAllocator_ctorStatic(&tlsf, buffer, 0));
+    // an unaligned buffer loses the room for a block
+    ASSERT_FALSE(TlsfAllocator_ctorStatic(&tlsf, buffer + 1,
+                                          sizeof(buffer) - 1));
+    ASSERT_TRUE(TlsfAllocator_ctorStatic(&tlsf, buffer, sizeof(buffer)));
+    ASSERT_EQ(TlsfAllocator_getFreeBytes(&tlsf), kHeaderSize);
+}
+
+// Blocks are split off the free space and merged back with both neighbours
+TEST_F(Test_TlsfAllocator, split_and_merge_pos)
+{
+    uint8_t* first = (uint8_t*) Allocator_alloc(allocator, 1);
+    uint8_t* second = (uint8_t*) Allocator_alloc(allocator, 100);
+    uint8_t* third = (uint8_t*) Allocator_alloc(allocator, 1000);
+
+    ASSERT_NE(first, nullptr);
+    ASSERT_EQ(second, first + kHeaderSize + kHeaderSize);
+    ASSERT_EQ((uintptr_t) third % TlsfAllocator_ALIGN_SIZE, 0);
+    ASSERT_EQ(Allocator_usableSize(allocator, second), 112);
+    ASSERT_EQ(Allocator_alloc(allocator, 0), nullptr);
+    ASSERT_EQ(Allocator_alloc(allocator, kPoolSize), nullptr);
+    ASSERT_EQ(TlsfAllocator_getUsedBytes(&tlsf),
+              kHeaderSize + 112 + 1008);
+    ASSERT_EQ(TlsfAllocator_getFreeBytes(&tlsf),
+              initialFreeBytes - TlsfAllocator_getUsedBytes(&tlsf)
+              - 3 * kHeaderSize);
+
+    // the hole left by the second block is reused
+    Allocator_free(allocator, second);
+    ASSERT_EQ(Allocator_alloc(allocator, 50), second);
+    Allocator_free(allocator, second);
+
+    // freeing twice or inside a block is caught
+    Allocator_free(allocator, second);
+    Allocator_free(allocator, third + kHeaderSize);
+    ASSERT_EQ(Allocator_usableSize(allocator, second), 0);
+
+    Allocator_free(allocator, first);
+    Allocator_free(allocator, third);
+}
+
+TEST_F(Test_TlsfAllocator, realloc_in_place_and_move_pos)
+{
+    uint8_t* block = (uint8_t*) Allocator_alloc(allocator, 64);
+    uint8_t* behind = (uint8_t*) Allocator_alloc(allocator, 64);
+    memset(block, 0x5A, 64);
+
+    // grows into the free block behind it
+    Allocator_free(allocator, behind);
+    ASSERT_EQ(Allocator_realloc(allocator, block, 200), block);
+    ASSERT_EQ(Allocator_usableSize(allocator, block), 208);
+    // shrinks in place
+    ASSERT_EQ(Allocator_realloc(allocator, block, 16), block);
+    ASSERT_EQ(Allocator_usableSize(allocator, block), 16);
+
+    // moves when the neighbour is used
+    behind = (uint8_t*) Allocator_alloc(allocator, 16);
+    ASSERT_EQ(behind, block + 16 + kHeaderSize);
+    uint8_t* moved = (uint8_t*) Allocator_realloc(allocator, block, 64);
+    ASSERT_NE(moved, block);
+    for (size_t i = 0; i < 16; i++)
+    {
+        ASSERT_EQ(moved[i], 0x5A);
+    }
+    Allocator_free(allocator, behind);
+    Allocator_free(allocator, moved);
+}
+
+// Random traffic, every block keeps its content and the accounting matches
+TEST_F(Test_TlsfAllocator, random_alloc_free_pos)
+{
+    std::mt19937 rng(3);
+    std::map<uint8_t*, size_t> live;
+
+    for (size_t i = 0; i < 20000; i++)
+    {
+        if (live.size() < 200 && (rng() % 2))
+        {
+            size_t size = 1 + rng() % ((rng() % 8) ? 64 : 4000);
+            uint8_t* block = (uint8_t*) Allocator_alloc(allocator, size);
+            if (block != NULL)
+            {
+                ASSERT_GE(Allocator_usableSize(allocator, block), size);
+                memset(block, (int) (size & 0xFF), size);
+                live[block] = size;
+            }
+        }
+        else if (!live.empty())
+        {
+            auto it = live.begin();
+            std::advance(it, rng() % live.size());
+            for (size_t j = 0; j < it->second; j++)
+            {
+                ASSERT_EQ(it->first[j], it->second & 0xFF);
+            }
+            Allocator_free(allocator, it->first);
+            live.erase(it);
+        }
+        ASSERT_LE(TlsfAllocator_getUsedBytes(&tlsf)
+                  + TlsfAllocator_getFreeBytes(&tlsf),
+                  initialFreeBytes);
+    }
+    for (auto& block : live)
+    {
+        Allocator_free(allocator, block.first);
+    }
+}
+
+// The pool is filled with small blocks, every other one is freed again and
+// only the end of the pool has room for a larger block. The TLSF lookup finds
+// it without crossing the pool, Benchmark_Allocators.cpp measures the latency
+// against a BitmapAllocator.
+TEST_F(Test_TlsfAllocator, fragmented_pool_tail_pos)
+{
+    constexpr size_t kBlockSize = 16;
+    constexpr size_t kNumBlocks = kPoolSize / (kBlockSize + kHeaderSize) - 1;
+    constexpr size_t kTail      = 16;
+    std::vector<uint8_t*> blocks(kNumBlocks);
+    size_t kept = 0;
+    uint8_t* lastKept = NULL;
+
+    for (auto& block : blocks)
+    {
+        block = (uint8_t*) Allocator_alloc(allocator, kBlockSize);
+        ASSERT_NE(block, nullptr);
+    }
+    for (size_t i = 0; i < kNumBlocks; i++)
+    {
+        if (i % 2 || i >= kNumBlocks - kTail)
+        {
+            Allocator_free(allocator, blocks[i]);
+            blocks[i] = NULL;
+        }
+        else
+        {
+            kept++;
+            lastKept = blocks[i];
+        }
+    }
+    ASSERT_EQ(TlsfAllocator_getUsedBytes(&tlsf), kept * kBlockSize);
+
+    // none of the holes fits, the block comes from the tail
+    uint8_t* large = (uint8_t*) Allocator_alloc(allocator, 4 * kBlockSize);
+    ASSERT_NE(large, nullptr);
+    ASSERT_GT(large, lastKept);
+    ASSERT_EQ(TlsfAllocator_getUsedBytes(&tlsf), (kept + 4) * kBlockSize);
+
+    Allocator_free(allocator, large);
+    for (uint8_t* block : blocks)
+    {
+        Allocator_free(allocator, block);
+    }
+}